@@ -0,0 +1,42 @@
+-- Level 1, loaded by Game::LoadLevel(1)
+-- Textures are queued for loading before any entity is created, entities refer to them by id.
+-- Every entity lists its components, the names match the engine components.
+return {
+	assets = {
+		textures = {
+			{ id = "jungle-tiles", file = "./assets/tilemaps/jungle.png" },
+			{ id = "tank-image", file = "./assets/images/tank-panther-right.png" },
+			{ id = "truck-image", file = "./assets/images/truck-ford-right.png" }
+		}
+	},
+
+	-- Comma separated tile indices, tiles are numbered row by row through the tile texture
+	tilemap = {
+		file = "./assets/tilemaps/jungle.map",
+		texture = "jungle-tiles",
+		tileSize = 32,
+		textureColumns = 10,
+		scale = 1.0
+	},
+
+	entities = {
+		{
+			-- Tank
+			components = {
+				transform = { position = { x = 10, y = 30 }, scale = { x = 1, y = 1 }, rotation = 0 },
+				rigidbody = { velocity = { x = 0, y = 40 } },
+				sprite = { texture = "tank-image" },
+				script = { behaviour = "patrol" }
+			}
+		},
+		{
+			-- Truck
+			components = {
+				transform = { position = { x = 50, y = 100 }, scale = { x = 1, y = 1 }, rotation = 0 },
+				rigidbody = { velocity = { x = 70, y = 0 } },
+				sprite = { texture = "truck-image" },
+				script = { behaviour = "bounce" }
+			}
+		}
+	}
+}
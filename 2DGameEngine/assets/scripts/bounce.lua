@@ -0,0 +1,32 @@
+-- Turns entities around when they leave the window
+-- update is called once per simulation tick with every entity using this behaviour
+local bounce = {}
+
+-- Only reads and writes the entities it is given, so large batches are split over the job workers
+bounce.parallel = true
+
+function bounce.update(batch, deltaTime)
+	-- Views read the component pools in place, get and set do not allocate.
+	-- Looking the methods up once keeps the loop from searching the view metatable per call.
+	local positions = batch.positions
+	local velocities = batch.velocities
+	local getPosition = positions.get
+	local getVelocity = velocities.get
+	local setVelocity = velocities.set
+
+	for i = 1, #positions do
+		local x, y = getPosition(positions, i)
+		local velocityX, velocityY = getVelocity(velocities, i)
+		if x and velocityX then
+			if (x < 0 and velocityX < 0) or (x > windowWidth and velocityX > 0) then
+				velocityX = -velocityX
+			end
+			if (y < 0 and velocityY < 0) or (y > windowHeight and velocityY > 0) then
+				velocityY = -velocityY
+			end
+			setVelocity(velocities, i, velocityX, velocityY)
+		end
+	end
+end
+
+return bounce
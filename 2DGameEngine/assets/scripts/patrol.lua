@@ -0,0 +1,16 @@
+-- Drives up and down, stopping for a moment before turning around
+-- run is started as a coroutine for every entity using this behaviour, wait(seconds) sleeps without any per tick cost
+local patrol = {}
+
+function patrol.run(entity)
+	local speed = 40
+	while true do
+		entity.velocity = vec2(0, speed)
+		wait(3.0)
+		entity.velocity = vec2(0, 0)
+		wait(1.0)
+		speed = -speed
+	end
+end
+
+return patrol
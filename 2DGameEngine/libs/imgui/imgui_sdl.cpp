@@ -174,6 +174,10 @@ namespace
 		LRUCache<UniformColorTriangleKey, std::unique_ptr<TriangleCacheItem>, UniformColorTriangleCacheSize> UniformColorTriangleCache;
 		LRUCache<GenericTriangleKey, std::unique_ptr<TriangleCacheItem>, GenericTriangleCacheSize> GenericTriangleCache;
 
+		// Whether draw commands are submitted whole with SDL_RenderGeometry. Cleared if the renderer rejects geometry,
+		// everything then goes through the per triangle path above.
+		bool UseGeometry = false;
+
 		Device(SDL_Renderer* renderer) : Renderer(renderer) { }
 
 		void SetClipRect(const ClipRect& rect)
@@ -515,6 +519,35 @@ namespace
 		SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
 		DrawRectangle(bounding, texture, width, height, color, doHorizontalFlip, doVerticalFlip);
 	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	// Submits all triangles of a draw command in a single call, the vertex buffer is passed as is without conversion.
+	// Returns false if the renderer can not draw geometry.
+	bool DrawCommandGeometry(const ImDrawList* commandList, const ImDrawCmd* drawCommand, SDL_Texture* texture)
+	{
+		const ImDrawVert* vertices = commandList->VtxBuffer.Data + drawCommand->VtxOffset;
+		const int vertexCount = commandList->VtxBuffer.Size - static_cast<int>(drawCommand->VtxOffset);
+		const ImDrawIdx* indices = commandList->IdxBuffer.Data + drawCommand->IdxOffset;
+
+#if SDL_VERSION_ATLEAST(2, 0, 19)
+		const SDL_Color* colors = reinterpret_cast<const SDL_Color*>(&vertices->col);
+#else
+		const int* colors = reinterpret_cast<const int*>(&vertices->col);
+#endif
+
+		// The rectangle path tints the font texture with a color mod, the vertex colors do that here
+		if (texture)
+		{
+			SDL_SetTextureColorMod(texture, 255, 255, 255);
+		}
+
+		return SDL_RenderGeometryRaw(CurrentDevice->Renderer, texture,
+			&vertices->pos.x, sizeof(ImDrawVert),
+			colors, sizeof(ImDrawVert),
+			&vertices->uv.x, sizeof(ImDrawVert),
+			vertexCount, indices, static_cast<int>(drawCommand->ElemCount), sizeof(ImDrawIdx)) == 0;
+	}
+#endif
 }
 
 namespace ImGuiSDL
@@ -542,6 +575,12 @@ namespace ImGuiSDL
 		io.Fonts->TexID = (void*)texture;
 
 		CurrentDevice = new Device(renderer);
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		// Whole draw lists can be submitted as geometry, which also lets ImGui emit meshes larger than 64K vertices
+		CurrentDevice->UseGeometry = true;
+		io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+#endif
 	}
 
 	void Deinitialize()
@@ -574,7 +613,6 @@ namespace ImGuiSDL
 		for (int n = 0; n < drawData->CmdListsCount; n++)
 		{
 			auto commandList = drawData->CmdLists[n];
-			auto vertexBuffer = commandList->VtxBuffer;
 			auto indexBuffer = commandList->IdxBuffer.Data;
 
 			for (int cmd_i = 0; cmd_i < commandList->CmdBuffer.Size; cmd_i++)
@@ -596,9 +634,23 @@ namespace ImGuiSDL
 				else
 				{
 					const bool isWrappedTexture = drawCommand->TextureId == io.Fonts->TexID;
+					const ImDrawVert* vertexBuffer = commandList->VtxBuffer.Data + drawCommand->VtxOffset;
+					bool isDrawn = false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+					if (CurrentDevice->UseGeometry)
+					{
+						SDL_Texture* texture = isWrappedTexture ? static_cast<const Texture*>(drawCommand->TextureId)->Source : static_cast<SDL_Texture*>(drawCommand->TextureId);
+						isDrawn = DrawCommandGeometry(commandList, drawCommand, texture);
+						if (!isDrawn)
+						{
+							CurrentDevice->UseGeometry = false;
+						}
+					}
+#endif
 
 					// Loops over triangles.
-					for (unsigned int i = 0; i + 3 <= drawCommand->ElemCount; i += 3)
+					for (unsigned int i = 0; !isDrawn && i + 3 <= drawCommand->ElemCount; i += 3)
 					{
 						const ImDrawVert& v0 = vertexBuffer[indexBuffer[i + 0]];
 						const ImDrawVert& v1 = vertexBuffer[indexBuffer[i + 1]];
@@ -0,0 +1,186 @@
+#include "AssetArchive.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t AssetArchive::HashPath(const std::string& path) {
+	size_t start = 0;
+	while (path.compare(start, 2, "./") == 0 || path.compare(start, 2, ".\\") == 0) {
+		start += 2;
+	}
+
+	uint64_t hash = FNV_OFFSET_BASIS;
+	for (size_t i = start; i < path.size(); i++) {
+		char c = path[i] == '\\' ? '/' : path[i];
+		hash ^= static_cast<uint8_t>(c);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+uint64_t AssetArchive::HashBytes(const uint8_t* data, size_t size) {
+	uint64_t hash = FNV_OFFSET_BASIS;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+bool AssetArchive::Pack(const std::string& archivePath, const std::string& directory, const PackTransform& transform) {
+	std::vector<std::string> filePaths;
+	std::error_code error;
+	for (const auto& item : std::filesystem::recursive_directory_iterator(directory, error)) {
+		if (item.is_regular_file()) {
+			filePaths.push_back(item.path().generic_string());
+		}
+	}
+	if (error) {
+		MIRAGE_LOG_ERROR("Error reading directory {}: {}", directory, error.message());
+		return false;
+	}
+
+	std::ofstream archive(archivePath, std::ios::binary);
+	if (!archive) {
+		MIRAGE_LOG_ERROR("Error creating archive {}", archivePath);
+		return false;
+	}
+
+	// The header is written last, once the table of contents offset is known
+	ArchiveHeader header = {};
+	archive.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	uint64_t offset = sizeof(header);
+
+	std::vector<ArchiveEntry> entries;
+	for (const auto& filePath : filePaths) {
+		std::ifstream file(filePath, std::ios::binary);
+		std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (!file.good() && !file.eof()) {
+			MIRAGE_LOG_ERROR("Error reading {}", filePath);
+			return false;
+		}
+		if (transform && !transform(filePath, contents)) {
+			return false;
+		}
+
+		// Align every blob so it can be used in place
+		const uint64_t padding = (ARCHIVE_ALIGNMENT - offset % ARCHIVE_ALIGNMENT) % ARCHIVE_ALIGNMENT;
+		const char zeros[ARCHIVE_ALIGNMENT] = {};
+		archive.write(zeros, static_cast<std::streamsize>(padding));
+		offset += padding;
+
+		ArchiveEntry entry = {};
+		entry.idHash = HashPath(filePath);
+		entry.offset = offset;
+		entry.size = contents.size();
+		entry.originalSize = contents.size();
+		entries.push_back(entry);
+
+		archive.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		offset += contents.size();
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) {
+		return a.idHash < b.idHash;
+	});
+	for (size_t i = 1; i < entries.size(); i++) {
+		if (entries[i].idHash == entries[i - 1].idHash) {
+			MIRAGE_LOG_ERROR("Error packing {}: two asset paths have the same hash", archivePath);
+			return false;
+		}
+	}
+
+	const uint64_t padding = (ARCHIVE_ALIGNMENT - offset % ARCHIVE_ALIGNMENT) % ARCHIVE_ALIGNMENT;
+	const char zeros[ARCHIVE_ALIGNMENT] = {};
+	archive.write(zeros, static_cast<std::streamsize>(padding));
+	offset += padding;
+	archive.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ArchiveEntry)));
+
+	header.magic = ARCHIVE_MAGIC;
+	header.version = ARCHIVE_VERSION;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.tocOffset = offset;
+	archive.seekp(0);
+	archive.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if (!archive) {
+		MIRAGE_LOG_ERROR("Error writing archive {}", archivePath);
+		return false;
+	}
+	MIRAGE_LOG_INFO("Packed {} files from {} into {}", entries.size(), directory, archivePath);
+	return true;
+}
+
+bool AssetArchive::Open(const std::string& archivePath) {
+	Close();
+	if (!file.Open(archivePath)) {
+		return false;
+	}
+
+	const uint8_t* data = file.GetData();
+	const size_t size = file.GetSize();
+	const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(data);
+	if (size < sizeof(ArchiveHeader) || header->magic != ARCHIVE_MAGIC || header->version != ARCHIVE_VERSION) {
+		MIRAGE_LOG_ERROR("Error opening archive {}: not an asset archive of version {}", archivePath, ARCHIVE_VERSION);
+		Close();
+		return false;
+	}
+
+	if (header->tocOffset > size || (size - header->tocOffset) / sizeof(ArchiveEntry) < header->entryCount) {
+		MIRAGE_LOG_ERROR("Error opening archive {}: the table of contents is truncated", archivePath);
+		Close();
+		return false;
+	}
+
+	entries = reinterpret_cast<const ArchiveEntry*>(data + header->tocOffset);
+	entryCount = header->entryCount;
+	for (uint32_t i = 0; i < entryCount; i++) {
+		if (entries[i].offset > size || entries[i].size > size - entries[i].offset) {
+			MIRAGE_LOG_ERROR("Error opening archive {}: an entry points outside of the file", archivePath);
+			Close();
+			return false;
+		}
+	}
+
+	MIRAGE_LOG_INFO("Mounted archive {} with {} assets", archivePath, entryCount);
+	return true;
+}
+
+void AssetArchive::Close() {
+	file.Close();
+	entries = nullptr;
+	entryCount = 0;
+}
+
+bool AssetArchive::IsOpen() const {
+	return file.IsOpen();
+}
+
+bool AssetArchive::Find(const std::string& path, const uint8_t*& data, size_t& size) const {
+	if (!entries) {
+		return false;
+	}
+
+	const uint64_t idHash = HashPath(path);
+	const ArchiveEntry* end = entries + entryCount;
+	const ArchiveEntry* entry = std::lower_bound(entries, end, idHash, [](const ArchiveEntry& entry, uint64_t hash) {
+		return entry.idHash < hash;
+	});
+	if (entry == end || entry->idHash != idHash) {
+		return false;
+	}
+
+	if (entry->flags & (ARCHIVE_ENTRY_LZ4 | ARCHIVE_ENTRY_ZSTD)) {
+		MIRAGE_LOG_ERROR("Error reading {} from the archive: compressed entries are not supported", path);
+		return false;
+	}
+
+	data = file.GetData() + entry->offset;
+	size = static_cast<size_t>(entry->size);
+	return true;
+}
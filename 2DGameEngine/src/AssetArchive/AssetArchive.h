@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Packed asset archive layout, all integers little endian:
+//   ArchiveHeader
+//   file contents, each starting at a multiple of ARCHIVE_ALIGNMENT
+//   ArchiveEntry table of contents sorted by id hash, at tocOffset
+const uint32_t ARCHIVE_MAGIC = 0x4B41504D; // "MPAK"
+const uint32_t ARCHIVE_VERSION = 1;
+const uint64_t ARCHIVE_ALIGNMENT = 64;
+
+enum ArchiveEntryFlags {
+	// Reserved for compressed entries, the packer does not write them yet
+	ARCHIVE_ENTRY_LZ4 = 1 << 0,
+	ARCHIVE_ENTRY_ZSTD = 1 << 1
+};
+
+struct ArchiveHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+	uint64_t tocOffset;
+};
+
+struct ArchiveEntry {
+	// Hash of the normalized asset path
+	uint64_t idHash;
+	uint64_t offset;
+	// Bytes stored in the archive
+	uint64_t size;
+	// Bytes after decompression, equal to size for uncompressed entries
+	uint64_t originalSize;
+	uint32_t flags;
+	uint32_t reserved;
+};
+
+// Lets the packer store a file differently, like a script compiled to bytecode. Gets the path and contents of
+// every file and may replace the contents, returns false to fail the whole pack.
+typedef std::function<bool(const std::string& filePath, std::vector<char>& contents)> PackTransform;
+
+// A memory mapped archive, lookups return pointers straight into the mapping.
+// Read only after Open, so any thread can look up and read entries.
+class AssetArchive
+{
+private:
+	MappedFile file;
+	const ArchiveEntry* entries = nullptr;
+	uint32_t entryCount = 0;
+
+public:
+	// FNV-1a of the path with backslashes turned into slashes and a leading "./" removed,
+	// so "./assets/images/tree.png" and "assets\images\tree.png" are the same id
+	static uint64_t HashPath(const std::string& path);
+	// FNV-1a of raw bytes
+	static uint64_t HashBytes(const uint8_t* data, size_t size);
+
+	// Packs every file below the directory, returns false on errors or hash collisions
+	static bool Pack(const std::string& archivePath, const std::string& directory, const PackTransform& transform = nullptr);
+
+	bool Open(const std::string& archivePath);
+	void Close();
+	bool IsOpen() const;
+
+	// Points data at the stored bytes of the asset, returns false if the archive does not contain it
+	bool Find(const std::string& path, const uint8_t*& data, size_t& size) const;
+};
@@ -0,0 +1,104 @@
+#include "MappedFile.h"
+#include "../Logger/Logger.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filePath) {
+	Close();
+
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		MIRAGE_LOG_ERROR("Error opening {}", filePath);
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		MIRAGE_LOG_ERROR("Error mapping {}: the file is empty", filePath);
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	// The view keeps the mapping and the file alive, the handles are not needed anymore
+	CloseHandle(file);
+	if (!mapping) {
+		MIRAGE_LOG_ERROR("Error mapping {}", filePath);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!view) {
+		MIRAGE_LOG_ERROR("Error mapping {}", filePath);
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	data = nullptr;
+	size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filePath) {
+	Close();
+
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0) {
+		MIRAGE_LOG_ERROR("Error opening {}", filePath);
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+		MIRAGE_LOG_ERROR("Error mapping {}: the file is empty", filePath);
+		close(file);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps the file alive
+	close(file);
+	if (view == MAP_FAILED) {
+		MIRAGE_LOG_ERROR("Error mapping {}", filePath);
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileStat.st_size);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (data) {
+		munmap(const_cast<uint8_t*>(data), size);
+	}
+	data = nullptr;
+	size = 0;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Read only memory mapping of a whole file, pages are loaded by the OS on first access
+class MappedFile
+{
+private:
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Maps the file, returns false if it can not be opened or is empty
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const {
+		return data != nullptr;
+	}
+
+	const uint8_t* GetData() const {
+		return data;
+	}
+
+	size_t GetSize() const {
+		return size;
+	}
+};
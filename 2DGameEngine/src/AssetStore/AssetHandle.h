@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// Typed handle into one of the AssetStore flat asset tables.
+// The generation detects handles to slots that have been freed and reused.
+// Index 0 is never handed out, so a default constructed handle is invalid.
+template <typename TAsset>
+struct AssetHandle {
+	uint32_t index;
+	uint32_t generation;
+
+	AssetHandle(uint32_t index = 0, uint32_t generation = 0): index(index), generation(generation) {}
+
+	bool IsValid() const {
+		return index != 0;
+	}
+
+	bool operator ==(const AssetHandle& other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator !=(const AssetHandle& other) const {
+		return !(*this == other);
+	}
+};
+
+struct TextureInfo;
+
+typedef AssetHandle<TextureInfo> TextureHandle;
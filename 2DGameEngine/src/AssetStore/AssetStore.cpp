@@ -1,32 +1,670 @@
 #include "AssetStore.h"
 #include "../Logger/Logger.h"
+#include "../JobSystem/JobSystem.h"
 #include <SDL_image.h>
+#include <filesystem>
+#include <algorithm>
+
+// Checkerboard shown while textures load
+const int PLACEHOLDER_SIZE = 16;
+const int PLACEHOLDER_CELL_SIZE = 8;
+
+// Memory owned by a texture, atlas regions and the placeholder own none
+static size_t GetTextureDataSize(const TextureInfo& textureInfo) {
+	if (!textureInfo.ownsTexture) {
+		return 0;
+	}
+	size_t bytes = 0;
+	if (textureInfo.texture) {
+		bytes += static_cast<size_t>(textureInfo.width) * textureInfo.height * 4;
+	}
+	if (textureInfo.pixels) {
+		bytes += static_cast<size_t>(textureInfo.pixels->pitch) * textureInfo.pixels->h;
+	}
+	return bytes;
+}
 
 AssetStore::AssetStore() {
-	Logger::Log("AssetStore constructor called");
+	// Slot 0 backs the invalid handle
+	textureSlots.resize(1);
+	textureSlots[0].isUsed = false;
+	textureSlots[0].generation = 0;
+	textureSlots[0].loadTicket = 0;
+	textureSlots[0].isLoading = false;
+	textureSlots[0].refCount = 0;
+	textureSlots[0].atlasIndex = 0;
+	textureSlots[0].releaseSequence = 0;
+	textureSlots[0].bytes = 0;
+	textureSlots[0].isEvicted = false;
+	textureCacheHits = 0;
+	textureCacheMisses = 0;
+	MIRAGE_LOG_INFO("AssetStore constructor called");
 }
 
 AssetStore::~AssetStore() {
 	ClearAssets();
-	Logger::Log("AssetStore deconstructor called");
+	MIRAGE_LOG_INFO("AssetStore deconstructor called");
 }
 
 void AssetStore::ClearAssets() {
-	for (auto texture : textures) {
-		SDL_DestroyTexture(texture.second);
+	for (uint32_t index = 1; index < textureSlots.size(); index++) {
+		if (textureSlots[index].isUsed) {
+			FreeTextureSlot(index);
+		}
+	}
+	textureIds.clear();
+
+	// Loads that finished decoding are dropped, loads still decoding are dropped when they arrive
+	std::vector<DecodedTexture> decoded;
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decoded.swap(decodedTextures);
+	}
+	decoded.insert(decoded.end(), uploadQueue.begin(), uploadQueue.end());
+	uploadQueue.clear();
+	for (auto& texture : decoded) {
+		SDL_FreeSurface(texture.surface);
+		SDL_FreeSurface(texture.pixels);
+		pendingLoads--;
+	}
+
+	if (hasPlaceholder) {
+		placeholderInfo.ownsTexture = true;
+		DestroyTextureData(placeholderInfo);
+		hasPlaceholder = false;
+	}
+	hasEvictedReferences = false;
+	isOverBudget = false;
+	revision++;
+}
+
+void AssetStore::SetKeepPixels(bool keepPixels) {
+	this->keepPixels = keepPixels;
+}
+
+void AssetStore::SetJobSystem(JobSystem* jobSystem) {
+	this->jobSystem = jobSystem;
+}
+
+void AssetStore::DestroyTextureData(TextureInfo& textureInfo) {
+	// Atlas regions share the data of their atlas
+	if (!textureInfo.ownsTexture) {
+		return;
+	}
+	if (textureInfo.texture) {
+		SDL_DestroyTexture(textureInfo.texture);
+	}
+	if (textureInfo.pixels) {
+		SDL_FreeSurface(textureInfo.pixels);
+	}
+}
+
+void AssetStore::SetSlotTexture(uint32_t index, const TextureInfo& textureInfo) {
+	TextureSlot& slot = textureSlots[index];
+	residentBytes -= slot.bytes;
+	DestroyTextureData(slot.info);
+	slot.info = textureInfo;
+	slot.bytes = GetTextureDataSize(textureInfo);
+	residentBytes += slot.bytes;
+
+	// Atlas regions point at the data of their atlas
+	for (auto& region : textureSlots) {
+		if (region.isUsed && region.atlasIndex == index) {
+			region.info.texture = textureInfo.texture;
+			region.info.pixels = textureInfo.pixels;
+			region.info.format = textureInfo.format;
+		}
+	}
+}
+
+void AssetStore::DetachFromAtlas(TextureSlot& slot) {
+	if (slot.atlasIndex != 0) {
+		textureSlots[slot.atlasIndex].refCount -= slot.refCount;
+		slot.atlasIndex = 0;
+	}
+}
+
+TextureHandle AssetStore::StoreTexture(const std::string& assetId, const TextureInfo& textureInfo) {
+	// Loading an asset id again replaces the texture behind its existing handle, its references are kept
+	auto existing = textureIds.find(assetId);
+	if (existing != textureIds.end()) {
+		TextureSlot& slot = textureSlots[existing->second.index];
+		DetachFromAtlas(slot);
+		SetSlotTexture(existing->second.index, textureInfo);
+		// Cancels async loads still running for this slot
+		slot.loadTicket++;
+		slot.isLoading = false;
+		slot.isEvicted = false;
+		revision++;
+		return existing->second;
+	}
+
+	uint32_t index;
+	if (!freeTextureSlots.empty()) {
+		index = freeTextureSlots.back();
+		freeTextureSlots.pop_back();
+	}
+	else {
+		index = static_cast<uint32_t>(textureSlots.size());
+		textureSlots.emplace_back();
+		textureSlots[index].generation = 0;
+		textureSlots[index].loadTicket = 0;
+		textureSlots[index].atlasIndex = 0;
+		textureSlots[index].bytes = 0;
+	}
+
+	TextureSlot& slot = textureSlots[index];
+	slot.isUsed = true;
+	slot.assetId = assetId;
+	slot.isLoading = false;
+	slot.filePath.clear();
+	slot.refCount = 0;
+	slot.releaseSequence = 0;
+	slot.isEvicted = false;
+	SetSlotTexture(index, textureInfo);
+
+	TextureHandle handle(index, slot.generation);
+	textureIds.emplace(assetId, handle);
+	return handle;
+}
+
+void AssetStore::FreeTextureSlot(uint32_t index) {
+	TextureSlot& slot = textureSlots[index];
+	DetachFromAtlas(slot);
+	TextureInfo emptyInfo = slot.info;
+	emptyInfo.texture = nullptr;
+	emptyInfo.pixels = nullptr;
+	SetSlotTexture(index, emptyInfo);
+
+	// Regions of a removed atlas draw nothing from now on
+	for (auto& region : textureSlots) {
+		if (region.isUsed && region.atlasIndex == index) {
+			region.atlasIndex = 0;
+		}
+	}
+
+	slot.isUsed = false;
+	slot.isLoading = false;
+	slot.isEvicted = false;
+	slot.refCount = 0;
+	slot.assetId.clear();
+	slot.filePath.clear();
+	// Invalidate every outstanding handle to this slot
+	slot.generation++;
+	freeTextureSlots.push_back(index);
+}
+
+bool AssetStore::MountArchive(const std::string& archivePath) {
+	return archive.Open(archivePath);
+}
+
+void AssetStore::SetTextureCacheDirectory(const std::string& directory) {
+	textureCache.SetDirectory(directory);
+}
+
+SDL_Surface* AssetStore::LoadSurface(const std::string& filePath, std::shared_ptr<MappedFile>& pixelMapping) const {
+	// The encoded file is read from the mapped archive or from a mapping of the loose file, never copied
+	const uint8_t* data;
+	size_t size;
+	int64_t modifiedTime = 0;
+	MappedFile sourceFile;
+	if (!archive.Find(filePath, data, size)) {
+		if (!sourceFile.Open(filePath)) {
+			return nullptr;
+		}
+		data = sourceFile.GetData();
+		size = sourceFile.GetSize();
+		std::error_code error;
+		modifiedTime = std::filesystem::last_write_time(filePath, error).time_since_epoch().count();
+	}
+
+	SDL_Surface* surface = textureCache.Load(filePath, data, size, modifiedTime, pixelMapping);
+	if (surface) {
+		textureCacheHits++;
+		return surface;
+	}
+
+	surface = IMG_Load_RW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1);
+	if (!surface || !textureCache.IsEnabled()) {
+		return surface;
+	}
+
+	// The cache stores RGBA32, which every renderer can take without another conversion
+	textureCacheMisses++;
+	SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(surface);
+	if (converted) {
+		textureCache.Store(filePath, data, size, modifiedTime, converted);
 	}
-	textures.clear();
+	return converted;
 }
 
-void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath) {
-	SDL_Surface* surface = IMG_Load(filePath.c_str());
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+bool AssetStore::CreateTextureInfo(SDL_Renderer* renderer, const std::string& assetId, SDL_Surface* surface, SDL_Surface* pixels, TextureInfo& textureInfo) {
+	// Record the texture metadata so the render loop never has to query it
+	textureInfo.texture = nullptr;
+	textureInfo.width = surface->w;
+	textureInfo.height = surface->h;
+	textureInfo.format = surface->format->format;
+	textureInfo.atlasRect = { 0, 0, textureInfo.width, textureInfo.height };
+	textureInfo.pixels = pixels;
+	textureInfo.ownsTexture = true;
+
+	// Without a renderer (headless or software rendering) no SDL texture is created
+	if (renderer) {
+		textureInfo.texture = SDL_CreateTextureFromSurface(renderer, surface);
+		if (!textureInfo.texture) {
+			MIRAGE_LOG_ERROR("Error creating texture {}: {}", assetId, SDL_GetError());
+			if (pixels) {
+				SDL_FreeSurface(pixels);
+			}
+			return false;
+		}
+		SDL_QueryTexture(textureInfo.texture, &textureInfo.format, NULL, NULL, NULL);
+	}
+	return true;
+}
+
+TextureHandle AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath) {
+	std::shared_ptr<MappedFile> pixelMapping;
+	SDL_Surface* surface = LoadSurface(filePath, pixelMapping);
+	if (!surface) {
+		MIRAGE_LOG_ERROR("Error loading texture {}: {}", filePath, IMG_GetError());
+		return TextureHandle();
+	}
+
+	SDL_Surface* pixels = nullptr;
+	if (keepPixels) {
+		pixels = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+	}
+
+	TextureInfo textureInfo;
+	const bool isCreated = CreateTextureInfo(renderer, assetId, surface, pixels, textureInfo);
 	SDL_FreeSurface(surface);
+	if (!isCreated) {
+		return TextureHandle();
+	}
 
-	// Add the texture to the map
-	textures.emplace(assetId, texture);
+	// Add the texture to the texture table
+	TextureHandle handle = StoreTexture(assetId, textureInfo);
+	textureSlots[handle.index].filePath = filePath;
+	return handle;
 }
 
-SDL_Texture* AssetStore::GetTexture(const std::string& assetId) {
-	return textures[assetId];
-}
\ No newline at end of file
+void AssetStore::CreatePlaceholder(SDL_Renderer* renderer) {
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, PLACEHOLDER_SIZE, PLACEHOLDER_SIZE, 32, SDL_PIXELFORMAT_RGBA32);
+	const Uint32 colors[2] = {
+		SDL_MapRGBA(surface->format, 255, 0, 255, 255),
+		SDL_MapRGBA(surface->format, 40, 40, 40, 255)
+	};
+	for (int y = 0; y < PLACEHOLDER_SIZE; y += PLACEHOLDER_CELL_SIZE) {
+		for (int x = 0; x < PLACEHOLDER_SIZE; x += PLACEHOLDER_CELL_SIZE) {
+			const SDL_Rect cell = { x, y, PLACEHOLDER_CELL_SIZE, PLACEHOLDER_CELL_SIZE };
+			SDL_FillRect(surface, &cell, colors[(x / PLACEHOLDER_CELL_SIZE + y / PLACEHOLDER_CELL_SIZE) % 2]);
+		}
+	}
+
+	// The surface is already RGBA32, so it doubles as the pixel copy for CPU renderers
+	if (!CreateTextureInfo(renderer, "placeholder", surface, surface, placeholderInfo)) {
+		// Loading sprites are not drawn at all then
+		placeholderInfo.texture = nullptr;
+		placeholderInfo.pixels = nullptr;
+	}
+	// Slots showing the placeholder must not destroy it
+	placeholderInfo.ownsTexture = false;
+	hasPlaceholder = true;
+}
+
+TextureHandle AssetStore::AddTextureAsync(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath) {
+	if (!jobSystem) {
+		return AddTexture(renderer, assetId, filePath);
+	}
+
+	if (!hasPlaceholder) {
+		CreatePlaceholder(renderer);
+	}
+
+	TextureHandle handle = GetTextureHandle(assetId);
+	if (!handle.IsValid()) {
+		handle = StoreTexture(assetId, placeholderInfo);
+	}
+
+	TextureSlot& slot = textureSlots[handle.index];
+	DetachFromAtlas(slot);
+	slot.filePath = filePath;
+	slot.loadTicket++;
+	slot.isLoading = true;
+
+	if (pendingLoads == 0) {
+		batchStartCounter = SDL_GetPerformanceCounter();
+		loadedInBatch = 0;
+		textureCacheHits = 0;
+		textureCacheMisses = 0;
+	}
+	pendingLoads++;
+
+	DecodedTexture request;
+	request.index = handle.index;
+	request.generation = handle.generation;
+	request.loadTicket = slot.loadTicket;
+	request.filePath = filePath;
+	request.surface = nullptr;
+	request.pixels = nullptr;
+
+	const bool convertPixels = keepPixels;
+	jobSystem->Submit([this, request, convertPixels]() mutable {
+		request.surface = LoadSurface(request.filePath, request.pixelMapping);
+		if (!request.surface) {
+			request.error = IMG_GetError();
+		}
+		else if (convertPixels) {
+			request.pixels = SDL_ConvertSurfaceFormat(request.surface, SDL_PIXELFORMAT_RGBA32, 0);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			decodedTextures.push_back(std::move(request));
+		}
+		decodedReady.notify_all();
+	});
+
+	return handle;
+}
+
+void AssetStore::UploadDecodedTexture(SDL_Renderer* renderer, DecodedTexture& decoded) {
+	pendingLoads--;
+
+	// Skip loads whose slot was removed, reused or loaded again in the meantime
+	TextureSlot& slot = textureSlots[decoded.index];
+	if (!slot.isUsed || slot.generation != decoded.generation || slot.loadTicket != decoded.loadTicket) {
+		SDL_FreeSurface(decoded.surface);
+		SDL_FreeSurface(decoded.pixels);
+		return;
+	}
+	slot.isLoading = false;
+
+	if (!decoded.surface) {
+		// The slot keeps showing what it showed before
+		MIRAGE_LOG_ERROR("Error loading texture {}: {}", decoded.filePath, decoded.error);
+		return;
+	}
+
+	TextureInfo textureInfo;
+	const bool isCreated = CreateTextureInfo(renderer, slot.assetId, decoded.surface, decoded.pixels, textureInfo);
+	SDL_FreeSurface(decoded.surface);
+	decoded.pixelMapping.reset();
+	if (!isCreated) {
+		return;
+	}
+
+	SetSlotTexture(decoded.index, textureInfo);
+	slot.isEvicted = false;
+	revision++;
+	loadedInBatch++;
+}
+
+int AssetStore::ProcessUploads(SDL_Renderer* renderer, double budgetMillisecs) {
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		uploadQueue.insert(uploadQueue.end(), decodedTextures.begin(), decodedTextures.end());
+		decodedTextures.clear();
+	}
+	if (uploadQueue.empty()) {
+		return 0;
+	}
+
+	const Uint64 start = SDL_GetPerformanceCounter();
+	const Uint64 budgetTicks = static_cast<Uint64>(budgetMillisecs * SDL_GetPerformanceFrequency() / 1000.0);
+
+	size_t uploaded = 0;
+	while (uploaded < uploadQueue.size()) {
+		UploadDecodedTexture(renderer, uploadQueue[uploaded]);
+		uploaded++;
+		if (SDL_GetPerformanceCounter() - start >= budgetTicks) {
+			break;
+		}
+	}
+	uploadQueue.erase(uploadQueue.begin(), uploadQueue.begin() + uploaded);
+
+	if (pendingLoads == 0 && loadedInBatch > 0) {
+		double millisecs = (SDL_GetPerformanceCounter() - batchStartCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+		MIRAGE_LOG_INFO(
+			"Loaded {} textures asynchronously in {} ms, {} from the texture cache and {} decoded",
+			loadedInBatch, millisecs, textureCacheHits.load(), textureCacheMisses.load()
+		);
+		loadedInBatch = 0;
+	}
+	return static_cast<int>(uploaded);
+}
+
+void AssetStore::WaitForLoads(SDL_Renderer* renderer) {
+	while (pendingLoads > 0) {
+		{
+			std::unique_lock<std::mutex> lock(decodedMutex);
+			decodedReady.wait(lock, [this] {
+				return !decodedTextures.empty() || !uploadQueue.empty();
+			});
+		}
+		// No budget while blocking anyway
+		ProcessUploads(renderer, 1000.0);
+	}
+}
+
+int AssetStore::GetNumPendingLoads() const {
+	return pendingLoads;
+}
+
+TextureHandle AssetStore::AddTextureRegion(const std::string& assetId, const std::string& atlasId, const SDL_Rect& region) {
+	const TextureHandle atlasHandle = GetTextureHandle(atlasId);
+	const TextureInfo* atlas = GetTextureInfo(atlasHandle);
+	if (!atlas) {
+		MIRAGE_LOG_ERROR("Error adding texture region {}: unknown atlas {}", assetId, atlasId);
+		return TextureHandle();
+	}
+
+	TextureInfo textureInfo = *atlas;
+	textureInfo.width = region.w;
+	textureInfo.height = region.h;
+	textureInfo.atlasRect = {
+		atlas->atlasRect.x + region.x,
+		atlas->atlasRect.y + region.y,
+		region.w,
+		region.h
+	};
+	// The atlas entry keeps ownership of the SDL texture
+	textureInfo.ownsTexture = false;
+
+	// A region of a region shares the data of the atlas at the root
+	uint32_t atlasIndex = textureSlots[atlasHandle.index].atlasIndex;
+	if (atlasIndex == 0) {
+		atlasIndex = atlasHandle.index;
+	}
+
+	TextureHandle handle = StoreTexture(assetId, textureInfo);
+	TextureSlot& slot = textureSlots[handle.index];
+	slot.filePath.clear();
+	slot.atlasIndex = atlasIndex;
+	textureSlots[atlasIndex].refCount += slot.refCount;
+	return handle;
+}
+
+void AssetStore::RemoveTexture(const std::string& assetId) {
+	auto texture = textureIds.find(assetId);
+	if (texture == textureIds.end()) {
+		return;
+	}
+	FreeTextureSlot(texture->second.index);
+	textureIds.erase(texture);
+}
+
+TextureHandle AssetStore::GetTextureHandle(const std::string& assetId) const {
+	auto texture = textureIds.find(assetId);
+	if (texture == textureIds.end()) {
+		return TextureHandle();
+	}
+	return texture->second;
+}
+
+const TextureInfo* AssetStore::GetTextureInfo(const std::string& assetId) const {
+	return GetTextureInfo(GetTextureHandle(assetId));
+}
+
+SDL_Texture* AssetStore::GetTexture(const std::string& assetId) const {
+	return GetTexture(GetTextureHandle(assetId));
+}
+
+int AssetStore::GetNumTextures() const {
+	return static_cast<int>(textureIds.size());
+}
+
+size_t AssetStore::GetTextureMemory() const {
+	return residentBytes;
+}
+
+size_t AssetStore::GetTextureBudget() const {
+	return textureBudget;
+}
+
+void AssetStore::AddRef(TextureHandle handle) {
+	if (!GetTextureInfo(handle)) {
+		return;
+	}
+
+	TextureSlot& slot = textureSlots[handle.index];
+	slot.refCount++;
+	if (slot.atlasIndex != 0) {
+		textureSlots[slot.atlasIndex].refCount++;
+	}
+
+	const TextureSlot& dataSlot = slot.atlasIndex != 0 ? textureSlots[slot.atlasIndex] : slot;
+	if (dataSlot.isEvicted) {
+		hasEvictedReferences = true;
+	}
+}
+
+void AssetStore::Release(TextureHandle handle) {
+	if (!GetTextureInfo(handle)) {
+		return;
+	}
+
+	TextureSlot& slot = textureSlots[handle.index];
+	if (slot.refCount <= 0) {
+		MIRAGE_LOG_ERROR("Texture {} released more often than it was referenced", slot.assetId);
+		return;
+	}
+	slot.refCount--;
+	if (slot.atlasIndex != 0) {
+		textureSlots[slot.atlasIndex].refCount--;
+	}
+
+	TextureSlot& dataSlot = slot.atlasIndex != 0 ? textureSlots[slot.atlasIndex] : slot;
+	if (dataSlot.refCount == 0) {
+		dataSlot.releaseSequence = ++releaseSequence;
+	}
+}
+
+void AssetStore::SetTextureBudget(size_t bytes) {
+	textureBudget = bytes;
+}
+
+void AssetStore::EvictTexture(uint32_t index) {
+	// The size is kept, sprites resolved against it stay valid until the texture is reloaded
+	TextureInfo evictedInfo = textureSlots[index].info;
+	evictedInfo.texture = nullptr;
+	evictedInfo.pixels = nullptr;
+	SetSlotTexture(index, evictedInfo);
+	textureSlots[index].isEvicted = true;
+}
+
+void AssetStore::TrimToBudget() {
+	if (textureBudget == 0 || residentBytes <= textureBudget) {
+		isOverBudget = false;
+		return;
+	}
+
+	// Unreferenced textures that can be reloaded, the least recently released first
+	std::vector<uint32_t> candidates;
+	for (uint32_t index = 1; index < textureSlots.size(); index++) {
+		const TextureSlot& slot = textureSlots[index];
+		if (slot.isUsed && slot.refCount == 0 && slot.bytes > 0 && !slot.isLoading && !slot.filePath.empty()) {
+			candidates.push_back(index);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) {
+		return textureSlots[a].releaseSequence < textureSlots[b].releaseSequence;
+	});
+
+	int evictedTextures = 0;
+	size_t evictedBytes = 0;
+	for (uint32_t index : candidates) {
+		if (residentBytes <= textureBudget) {
+			break;
+		}
+		evictedBytes += textureSlots[index].bytes;
+		EvictTexture(index);
+		evictedTextures++;
+	}
+
+	if (evictedTextures > 0) {
+		MIRAGE_LOG_INFO(
+			"Evicted {} textures, freed {} KB, {} KB of the {} KB budget resident",
+			evictedTextures, evictedBytes / 1024, residentBytes / 1024, textureBudget / 1024
+		);
+	}
+
+	// Whatever is left is referenced, only warn when the budget is first exceeded
+	if (residentBytes > textureBudget && !isOverBudget) {
+		MIRAGE_LOG_ERROR("Referenced textures use {} KB, more than the texture budget of {} KB", residentBytes / 1024, textureBudget / 1024);
+	}
+	isOverBudget = residentBytes > textureBudget;
+}
+
+void AssetStore::UpdateResidency(SDL_Renderer* renderer) {
+	if (hasEvictedReferences) {
+		hasEvictedReferences = false;
+		for (uint32_t index = 1; index < textureSlots.size(); index++) {
+			const TextureSlot& slot = textureSlots[index];
+			if (slot.isUsed && slot.isEvicted && !slot.isLoading && slot.refCount > 0) {
+				// Loads into the existing slot, nothing is shown until the upload
+				AddTextureAsync(renderer, slot.assetId, slot.filePath);
+			}
+		}
+	}
+
+	TrimToBudget();
+}
+
+int AssetStore::ReloadFile(SDL_Renderer* renderer, const std::string& filePath) {
+	// The watcher and the level may spell the same path differently, like ./assets/a.png and assets/a.png
+	const std::string normalizedPath = std::filesystem::path(filePath).lexically_normal().generic_string();
+
+	int reloaded = 0;
+	for (uint32_t index = 1; index < textureSlots.size(); index++) {
+		const TextureSlot& slot = textureSlots[index];
+		if (!slot.isUsed || slot.isEvicted || slot.filePath.empty()) {
+			continue;
+		}
+		if (std::filesystem::path(slot.filePath).lexically_normal().generic_string() != normalizedPath) {
+			continue;
+		}
+		// The old texture stays in the slot until the new one is uploaded
+		AddTextureAsync(renderer, slot.assetId, slot.filePath);
+		reloaded++;
+	}
+	return reloaded;
+}
+
+TextureResidency AssetStore::GetResidency(TextureHandle handle) const {
+	if (!GetTextureInfo(handle)) {
+		return TEXTURE_RESIDENCY_INVALID;
+	}
+
+	const TextureSlot& slot = textureSlots[handle.index];
+	const TextureSlot& dataSlot = slot.atlasIndex != 0 ? textureSlots[slot.atlasIndex] : slot;
+	if (slot.isLoading || dataSlot.isLoading) {
+		return TEXTURE_RESIDENCY_LOADING;
+	}
+	if (dataSlot.isEvicted) {
+		return TEXTURE_RESIDENCY_EVICTED;
+	}
+	return TEXTURE_RESIDENCY_RESIDENT;
+}
@@ -1,23 +1,215 @@
 #pragma once
-#include <map>
+#include <vector>
+#include <unordered_map>
 #include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
 #include <SDL.h>
+#include "AssetHandle.h"
+#include "../AssetArchive/AssetArchive.h"
+#include "../TextureCache/TextureCache.h"
+
+class JobSystem;
+
+// Metadata recorded once when a texture is loaded so nothing has to query SDL per frame
+struct TextureInfo {
+	SDL_Texture* texture;
+	int width;
+	int height;
+	Uint32 format;
+	// Region of the texture this asset covers, the whole texture unless it was added as an atlas region
+	SDL_Rect atlasRect;
+	// CPU copy in RGBA32 for the software render backend, null unless pixel retention is enabled
+	SDL_Surface* pixels;
+	bool ownsTexture;
+};
+
+enum TextureResidency {
+	TEXTURE_RESIDENCY_INVALID,
+	// Decoding, the placeholder or the previous texture is shown meanwhile
+	TEXTURE_RESIDENCY_LOADING,
+	TEXTURE_RESIDENCY_RESIDENT,
+	// Freed to stay within the texture budget, reloaded once it is referenced again
+	TEXTURE_RESIDENCY_EVICTED
+};
 
 class AssetStore
 {
 private:
-	std::map<std::string, SDL_Texture*> textures;
+	struct TextureSlot {
+		TextureInfo info;
+		uint32_t generation;
+		bool isUsed;
+		std::string assetId;
+		// Incremented by every load of the slot, only the newest async load is applied
+		uint32_t loadTicket;
+		bool isLoading;
+		// Reloaded from here after an eviction, empty for atlas regions
+		std::string filePath;
+		// References of atlas regions are counted on their atlas too
+		int refCount;
+		// Slot of the atlas owning the texture data, 0 unless this is an atlas region
+		uint32_t atlasIndex;
+		// Release order of unreferenced slots, the oldest is evicted first
+		uint64_t releaseSequence;
+		// Memory owned by the slot, counted in residentBytes
+		size_t bytes;
+		bool isEvicted;
+	};
+
+	// A texture decoded on a worker thread, waiting to be uploaded
+	struct DecodedTexture {
+		uint32_t index;
+		uint32_t generation;
+		uint32_t loadTicket;
+		std::string filePath;
+		SDL_Surface* surface;
+		// RGBA32 copy when pixels are kept
+		SDL_Surface* pixels;
+		// Set when the surface points into a mapped texture cache file
+		std::shared_ptr<MappedFile> pixelMapping;
+		std::string error;
+	};
+
+	// Flat texture table indexed by TextureHandle::index, slot 0 is reserved for the invalid handle
+	std::vector<TextureSlot> textureSlots;
+	std::vector<uint32_t> freeTextureSlots;
+
+	// Interns asset id strings to handles, only used at load time
+	std::unordered_map<std::string, TextureHandle> textureIds;
+	bool keepPixels = false;
+	// Assets found in the archive are decoded from its mapping, everything else from loose files
+	AssetArchive archive;
+	TextureCache textureCache;
+	// Counted by loads on any thread and reported with every finished batch of async loads
+	mutable std::atomic<int> textureCacheHits;
+	mutable std::atomic<int> textureCacheMisses;
+	// Incremented whenever the data behind a handle changes, users of cached texture sizes compare it
+	uint32_t revision = 0;
+
+	// Async loading, the decoded queue is filled by worker threads
+	JobSystem* jobSystem = nullptr;
+	std::mutex decodedMutex;
+	std::condition_variable decodedReady;
+	std::vector<DecodedTexture> decodedTextures;
+	std::vector<DecodedTexture> uploadQueue;
+	int pendingLoads = 0;
+	int loadedInBatch = 0;
+	Uint64 batchStartCounter = 0;
+
+	// Unreferenced textures are evicted once the resident bytes exceed the budget, 0 is unlimited
+	size_t textureBudget = 0;
+	size_t residentBytes = 0;
+	uint64_t releaseSequence = 0;
+	// Set when an evicted texture is referenced, the next UpdateResidency reloads it
+	bool hasEvictedReferences = false;
+	bool isOverBudget = false;
+
+	// Shown while a texture is loading, shared by all loading slots
+	TextureInfo placeholderInfo;
+	bool hasPlaceholder = false;
 	// map for fonts
 	// map for audio
 
+	TextureHandle StoreTexture(const std::string& assetId, const TextureInfo& textureInfo);
+	void FreeTextureSlot(uint32_t index);
+	void DestroyTextureData(TextureInfo& textureInfo);
+	// Replaces the data behind a slot, keeps the byte accounting and the atlas regions of the slot up to date
+	void SetSlotTexture(uint32_t index, const TextureInfo& textureInfo);
+	// Moves the references of an atlas region off its atlas before the slot is reused
+	void DetachFromAtlas(TextureSlot& slot);
+	void EvictTexture(uint32_t index);
+	void TrimToBudget();
+	bool CreateTextureInfo(SDL_Renderer* renderer, const std::string& assetId, SDL_Surface* surface, SDL_Surface* pixels, TextureInfo& textureInfo);
+	void CreatePlaceholder(SDL_Renderer* renderer);
+	void UploadDecodedTexture(SDL_Renderer* renderer, DecodedTexture& decoded);
+	// Thread safe, async loads call it on worker threads. pixelMapping is set if the surface
+	// points into a texture cache file and has to outlive the surface.
+	SDL_Surface* LoadSurface(const std::string& filePath, std::shared_ptr<MappedFile>& pixelMapping) const;
+
 public:
 	AssetStore();
 	~AssetStore();
 
 	void ClearAssets();
-	void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
-	SDL_Texture* GetTexture(const std::string& assetId);
+	// Keeps an RGBA32 copy of every texture loaded from now on, needed by CPU renderers
+	void SetKeepPixels(bool keepPixels);
+	// Worker threads for async loading, has to be destroyed before the asset store
+	void SetJobSystem(JobSystem* jobSystem);
+	// Loads assets from a packed archive from now on, must not be called while async loads are pending
+	bool MountArchive(const std::string& archivePath);
+	// Read only after mounting, other loaders like the script engine look their files up in it too
+	const AssetArchive& GetArchive() const {
+		return archive;
+	}
+	// Keeps decoded textures in this directory so later runs skip decoding, empty disables the cache.
+	// Must not be called while async loads are pending.
+	void SetTextureCacheDirectory(const std::string& directory);
+	TextureHandle AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
 
+	// Decodes the file on a worker thread and returns a handle right away. A placeholder is shown until
+	// ProcessUploads has uploaded the texture, loading an existing asset id keeps its old texture until then.
+	TextureHandle AddTextureAsync(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
+	// Uploads decoded textures until the time budget is used up, at least one per call.
+	// Must be called while nothing else reads the asset store. Returns the number of textures uploaded.
+	int ProcessUploads(SDL_Renderer* renderer, double budgetMillisecs);
+	// Blocks until every async load has been uploaded
+	void WaitForLoads(SDL_Renderer* renderer);
+	int GetNumPendingLoads() const;
 
-};
+	// Users of a texture hold a reference, only unreferenced textures are evicted. Called from the simulation
+	// tick while the render thread draws the previous frame with GetTexture and GetTextureInfo. That is only
+	// safe because these write nothing but the reference counts and release order, which rendering never
+	// reads, and because textureSlots does not grow during a tick. Adding or removing textures from the tick
+	// would reallocate it under the renderer.
+	void AddRef(TextureHandle handle);
+	void Release(TextureHandle handle);
+	// Bytes of texture data allowed to stay resident, 0 is unlimited
+	void SetTextureBudget(size_t bytes);
+	// Reloads evicted textures that are referenced again and evicts the least recently released
+	// ones while over budget. Called once per frame, while nothing else reads the asset store.
+	void UpdateResidency(SDL_Renderer* renderer);
+	TextureResidency GetResidency(TextureHandle handle) const;
+	// Loads every texture that was loaded from this file again, asynchronously like AddTextureAsync.
+	// Evicted textures load the new file once they are referenced. Returns the number of textures reloaded.
+	int ReloadFile(SDL_Renderer* renderer, const std::string& filePath);
+	// Registers a sub-rectangle of an already loaded texture as its own asset
+	TextureHandle AddTextureRegion(const std::string& assetId, const std::string& atlasId, const SDL_Rect& region);
+	void RemoveTexture(const std::string& assetId);
+
+	// Resolves an asset id to its handle, returns an invalid handle for unknown ids
+	TextureHandle GetTextureHandle(const std::string& assetId) const;
+
+	uint32_t GetRevision() const {
+		return revision;
+	}
+
+	// Returns nullptr if the handle is invalid or its texture has been removed
+	const TextureInfo* GetTextureInfo(TextureHandle handle) const {
+		if (handle.index >= textureSlots.size()) {
+			return nullptr;
+		}
+		const TextureSlot& slot = textureSlots[handle.index];
+		if (!slot.isUsed || slot.generation != handle.generation) {
+			return nullptr;
+		}
+		return &slot.info;
+	}
 
+	SDL_Texture* GetTexture(TextureHandle handle) const {
+		const TextureInfo* textureInfo = GetTextureInfo(handle);
+		return textureInfo ? textureInfo->texture : nullptr;
+	}
+
+	const TextureInfo* GetTextureInfo(const std::string& assetId) const;
+	SDL_Texture* GetTexture(const std::string& assetId) const;
+
+	// Statistics for the performance overlay, memory is estimated as 4 bytes per texel
+	int GetNumTextures() const;
+	size_t GetTextureMemory() const;
+	size_t GetTextureBudget() const;
+
+
+};
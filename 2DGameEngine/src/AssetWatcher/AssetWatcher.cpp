@@ -0,0 +1,163 @@
+#include "AssetWatcher.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+// Files are reloaded once they are closed after writing or moved into place, which is how most editors save
+#ifdef __linux__
+const uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+#endif
+
+AssetWatcher::AssetWatcher(int debounceMillisecs): debounceMillisecs(debounceMillisecs) {
+}
+
+#ifdef __linux__
+
+AssetWatcher::~AssetWatcher() {
+	if (thread.joinable()) {
+		const char wake = 1;
+		if (write(wakeFds[1], &wake, 1) != 1) {
+			MIRAGE_LOG_ERROR("Error waking up the asset watcher thread");
+		}
+		thread.join();
+	}
+	if (inotifyFd >= 0) {
+		close(inotifyFd);
+	}
+	if (wakeFds[0] >= 0) {
+		close(wakeFds[0]);
+		close(wakeFds[1]);
+	}
+}
+
+void AssetWatcher::AddWatch(const std::string& directory) {
+	int watch = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_EVENTS);
+	if (watch < 0) {
+		MIRAGE_LOG_ERROR("Error watching {}: {}", directory, strerror(errno));
+		return;
+	}
+	watchedDirectories[watch] = directory;
+
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.is_directory(error)) {
+			AddWatch(entry.path().generic_string());
+		}
+	}
+}
+
+bool AssetWatcher::Start(const std::string& directory) {
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0 || pipe(wakeFds) != 0) {
+		MIRAGE_LOG_ERROR("Error starting the asset watcher: {}", strerror(errno));
+		return false;
+	}
+
+	AddWatch(directory);
+	if (watchedDirectories.empty()) {
+		return false;
+	}
+
+	MIRAGE_LOG_INFO("Watching {} directories below {} for changed assets", watchedDirectories.size(), directory);
+	thread = std::thread(&AssetWatcher::WatchLoop, this);
+	return true;
+}
+
+void AssetWatcher::WatchLoop() {
+	Profiler::SetThreadName("Asset watcher");
+
+	alignas(inotify_event) char buffer[4096];
+	pollfd fds[2] = {
+		{ inotifyFd, POLLIN, 0 },
+		{ wakeFds[0], POLLIN, 0 }
+	};
+
+	while (true) {
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			MIRAGE_LOG_ERROR("Asset watcher stopped: {}", strerror(errno));
+			return;
+		}
+		if (fds[1].revents != 0) {
+			return;
+		}
+
+		ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		if (length <= 0) {
+			continue;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		for (char* position = buffer; position < buffer + length;) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(position);
+			position += sizeof(inotify_event) + event->len;
+
+			// The directory was deleted or moved away
+			if (event->mask & IN_IGNORED) {
+				watchedDirectories.erase(event->wd);
+				continue;
+			}
+
+			auto directory = watchedDirectories.find(event->wd);
+			if (directory == watchedDirectories.end() || event->len == 0) {
+				continue;
+			}
+			const std::string path = directory->second + "/" + event->name;
+
+			if (event->mask & IN_ISDIR) {
+				AddWatch(path);
+				continue;
+			}
+			// Created files are reported once they are closed
+			if (event->mask & IN_CREATE) {
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			changedFiles[path] = now;
+		}
+	}
+}
+
+#else
+
+AssetWatcher::~AssetWatcher() {
+}
+
+void AssetWatcher::AddWatch(const std::string& directory) {
+}
+
+bool AssetWatcher::Start(const std::string& directory) {
+	MIRAGE_LOG_ERROR("Asset hot reload is only supported on Linux");
+	return false;
+}
+
+void AssetWatcher::WatchLoop() {
+}
+
+#endif
+
+void AssetWatcher::GetChangedFiles(std::vector<std::string>& files) {
+	const auto settledTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(debounceMillisecs);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto file = changedFiles.begin(); file != changedFiles.end();) {
+		if (file->second <= settledTime) {
+			files.push_back(file->first);
+			file = changedFiles.erase(file);
+		}
+		else {
+			++file;
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+// Watches a directory tree for changed files on a background thread, only implemented with inotify on Linux.
+// Editors often save a file in several writes, so a file is reported once it has not changed for the debounce time.
+class AssetWatcher
+{
+private:
+	int debounceMillisecs;
+	std::thread thread;
+
+	std::mutex mutex;
+	// Changed files and the time of their last change, filled by the watcher thread
+	std::unordered_map<std::string, std::chrono::steady_clock::time_point> changedFiles;
+
+	// Only used on Linux
+	int inotifyFd = -1;
+	// Written to on shutdown to wake up the watcher thread
+	int wakeFds[2] = { -1, -1 };
+	// Watch descriptors to the directory they watch, only touched by the watcher thread once it runs
+	std::unordered_map<int, std::string> watchedDirectories;
+
+	// Watches the directory and every directory below it
+	void AddWatch(const std::string& directory);
+	void WatchLoop();
+
+public:
+	AssetWatcher(int debounceMillisecs);
+	~AssetWatcher();
+
+	AssetWatcher(const AssetWatcher&) = delete;
+	AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+	// Starts watching the directory and its subdirectories, returns false if that is not possible
+	bool Start(const std::string& directory);
+	// Appends the files whose changes have settled, the lock is only held to move them out
+	void GetChangedFiles(std::vector<std::string>& files);
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+
+struct ScriptComponent {
+	// Name of the Lua behaviour, loaded from assets/scripts/<behaviour>.lua
+	std::string behaviour;
+
+	// Filled by the ScriptSystem, -1 if the behaviour could not be loaded
+	int behaviourId;
+	// Coroutine running the run function of the behaviour, -1 if it has none
+	int coroutineId;
+
+	ScriptComponent(const std::string& behaviour = "") {
+		this->behaviour = behaviour;
+		this->behaviourId = -1;
+		this->coroutineId = -1;
+	}
+};
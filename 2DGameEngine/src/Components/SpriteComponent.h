@@ -1,19 +1,27 @@
 #pragma once
 
-#include <string>
 #include <SDL.h>
+#include "../AssetStore/AssetHandle.h"
 
 struct SpriteComponent {
-	std::string assetId;
+	TextureHandle texture;
+	// Requested size and source rectangle relative to the texture, zero means the size of the texture
 	int width;
 	int height;
 	SDL_Rect srcRect;
 
-	SpriteComponent(std::string assetId = "", int width = 0, int height = 0, int srcRectX = 0, int srcRectY = 0) {
-		this->assetId = assetId;
+	// Filled by the RenderSystem from the texture, the source rectangle is offset into the atlas
+	int resolvedWidth;
+	int resolvedHeight;
+	SDL_Rect resolvedSrcRect;
+
+	SpriteComponent(TextureHandle texture = TextureHandle(), int width = 0, int height = 0, int srcRectX = 0, int srcRectY = 0) {
+		this->texture = texture;
 		this->width = width;
 		this->height = height;
 		this->srcRect = { srcRectX, srcRectY, width, height };
+		this->resolvedWidth = 0;
+		this->resolvedHeight = 0;
+		this->resolvedSrcRect = { 0, 0, 0, 0 };
 	}
 };
-
@@ -6,10 +6,18 @@
 		glm::vec2 scale;
 		double rotation;
 
+		// State at the previous simulation tick, rendering interpolates from it towards the current state
+		glm::vec2 previousPosition;
+		glm::vec2 previousScale;
+		double previousRotation;
+
 		TransformComponent(glm::vec2 position = glm::vec2(0, 0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0) {
 			this->position = position;
 			this->scale = scale;
 			this->rotation = rotation;
+			this->previousPosition = position;
+			this->previousScale = scale;
+			this->previousRotation = rotation;
 		}
 
 	};
@@ -1,5 +1,6 @@
 #include "ECS.h"
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
 
 int BaseComponent::nextId = 0;
 
@@ -7,6 +8,10 @@ int Entity::GetId() const {
 	return id;
 }
 
+void Entity::Kill() {
+	registry->KillEntity(*this);
+}
+
 void System::AddEntityToSystem(Entity entity) {
 	entities.push_back(entity);
 }
@@ -16,7 +21,7 @@ void System::RemoveEntityFromSystem(Entity entity) {
 		}), entities.end());
 }
 
-std::vector<Entity> System::GetSystemEntities() const {
+const std::vector<Entity>& System::GetSystemEntities() const {
 	return entities;
 }
 const Signature& System::GetComponentSignature() const {
@@ -35,10 +40,35 @@ Entity Registry::CreateEntity() {
 		entityComponentSignatures.resize(entityId + 1);
 	}
 
-	Logger::Log("Entity created with id = " + std::to_string(entityId));
+	MIRAGE_LOG_DEBUG("Entity created with id = {}", entityId);
 	return entity;
 }
 
+std::vector<Entity> Registry::CreateEntities(int count) {
+	std::vector<Entity> entities;
+	entities.reserve(count);
+
+	const int firstEntityId = activeEntities;
+	if (firstEntityId + count > static_cast<int>(entityComponentSignatures.size())) {
+		entityComponentSignatures.resize(firstEntityId + count);
+	}
+
+	for (int i = 0; i < count; i++) {
+		Entity entity(activeEntities++);
+		entity.registry = this;
+		// Ids only grow, so every insert goes to the end of the set
+		entitiesToBeAdded.insert(entitiesToBeAdded.end(), entity);
+		entities.push_back(entity);
+	}
+
+	MIRAGE_LOG_INFO("Created {} entities with ids {} to {}", count, firstEntityId, activeEntities - 1);
+	return entities;
+}
+
+void Registry::KillEntity(Entity entity) {
+	entitiesToBeKilled.insert(entity);
+}
+
 void Registry::AddEntityToSystems(Entity entity) {
 	const int entityId = entity.GetId();
 
@@ -51,14 +81,54 @@ void Registry::AddEntityToSystems(Entity entity) {
 		if (isInterested) {
 			// add entity to system
 			system.second->AddEntityToSystem(entity);
+			system.second->OnEntityAdded(entity);
+		}
+	}
+}
+
+void Registry::RemoveEntityFromSystems(Entity entity) {
+	const auto& entityComponentSignature = entityComponentSignatures[entity.GetId()];
+
+	for (auto& system : systems) {
+		const auto& systemComponentSignature = system.second->GetComponentSignature();
+
+		bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
+		if (isInterested) {
+			system.second->OnEntityRemoved(entity);
+			system.second->RemoveEntityFromSystem(entity);
 		}
 	}
 }
 
 void Registry::Update() {
+	PROFILE_SCOPE("Registry::Update");
+
 	// Add the entities that are waiting to be created
 	for (auto entity : entitiesToBeAdded) {
 		AddEntityToSystems(entity);
 	}
 	entitiesToBeAdded.clear();
-}
\ No newline at end of file
+
+	// Remove the entities that are waiting to be killed
+	for (auto entity : entitiesToBeKilled) {
+		RemoveEntityFromSystems(entity);
+		entityComponentSignatures[entity.GetId()].reset();
+		MIRAGE_LOG_DEBUG("Entity killed with id = {}", entity.GetId());
+	}
+	entitiesToBeKilled.clear();
+}
+
+int Registry::GetNumEntities() const {
+	return activeEntities;
+}
+
+int Registry::GetNumComponentPools() const {
+	return static_cast<int>(componentPools.size());
+}
+
+const IPool* Registry::GetComponentPool(int componentId) const {
+	if (componentId < 0 || componentId >= GetNumComponentPools()) {
+		return nullptr;
+	}
+	return componentPools[componentId].get();
+}
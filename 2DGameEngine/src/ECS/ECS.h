@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <typeindex>
 #include <set>
+#include <algorithm>
 #include "../Logger/Logger.h"
 
 const unsigned int MAX_COMPONENTS = 32;
@@ -59,6 +60,8 @@ public:
 	template <typename TComponent> void RemoveComponent();
 	template <typename TComponent> bool HasComponent() const;
 	template <typename TComponent> TComponent& GetComponent() const;
+	// The entity is removed from its systems in the next registry Update()
+	void Kill();
 
 	class Registry* registry;
 
@@ -71,11 +74,15 @@ private:
 
 public:
 	System() = default;
-	~System() = default;
+	virtual ~System() = default;
 
 	void AddEntityToSystem(Entity entity);
+	// Called once an entity matching the component signature has been added to the system
+	virtual void OnEntityAdded(Entity entity) {}
+	// Called before a killed entity is removed from the system, its components are still readable
+	virtual void OnEntityRemoved(Entity entity) {}
 	void RemoveEntityFromSystem(Entity entity);
-	std::vector<Entity> GetSystemEntities() const;
+	const std::vector<Entity>& GetSystemEntities() const;
 	const Signature& GetComponentSignature() const;
 
 	template <typename TComponent> void RequireComponent();
@@ -85,8 +92,19 @@ public:
 
 
 class IPool {
+protected:
+	// Incremented whenever the storage may have moved, views into the pool compare it
+	uint32_t version = 0;
+
 public:
 	virtual ~IPool() {}
+	virtual int GetSize() const = 0;
+	// Bytes reserved by the pool
+	virtual size_t GetMemoryUsage() const = 0;
+
+	uint32_t GetVersion() const {
+		return version;
+	}
 };
 
 template <typename T>
@@ -105,20 +123,33 @@ public:
 		return data.empty();
 	}
 
-	int GetSize() const {
+	int GetSize() const override {
 		return data.size();
 	}
 
+	size_t GetMemoryUsage() const override {
+		return data.capacity() * sizeof(T);
+	}
+
 	void Resize(int newSize) {
+		const T* previousData = data.data();
 		data.resize(newSize);
+		if (data.data() != previousData) {
+			version++;
+		}
 	}
 
 	void Clear() {
 		data.clear();
+		version++;
 	}
 
 	void Add(T object) {
+		const T* previousData = data.data();
 		data.push_back(object);
+		if (data.data() != previousData) {
+			version++;
+		}
 	}
 
 	void Set(int index, T object) {
@@ -157,13 +188,15 @@ private:
 	std::set<Entity> entitiesToBeAdded;
 	std::set<Entity> entitiesToBeKilled;
 
+	template <typename TComponent> Pool<TComponent>* GetOrCreateComponentPool();
+
 public:
 	Registry() {
-		Logger::Log("Registry constructor called");
+		MIRAGE_LOG_INFO("Registry constructor called");
 	};
 
 	~Registry() {
-		Logger::Log("Registry destructor called");
+		MIRAGE_LOG_INFO("Registry destructor called");
 	};
 
 	// The registry update processes the entities that are waiting to be added/destroyed
@@ -171,9 +204,16 @@ public:
 
 	// Entity management
 	Entity CreateEntity();
+	// Creates count entities with consecutive ids, logging once for all of them
+	std::vector<Entity> CreateEntities(int count);
+	void KillEntity(Entity entity);
 
 	// Component management
 	template <typename TComponent, typename ...TArgs> void AddComponent(Entity entity, TArgs&& ...args);
+	// AddComponent without the log line, for bulk creation where logging would dominate the time spent
+	template <typename TComponent, typename ...TArgs> void EmplaceComponent(Entity entity, TArgs&& ...args);
+	// Grows the pool so entities with ids below numEntities can get the component without reallocating it
+	template <typename TComponent> void ReserveComponents(int numEntities);
 	template <typename TComponent> void RemoveComponent(Entity entity);
 	template <typename TComponent> bool HasComponent(Entity entity) const;
 	template <typename TComponent> TComponent& GetComponent(Entity entity) const;
@@ -186,6 +226,14 @@ public:
 
 	// Checks the component signature of an entity and addds it to the systems that are interested in it
 	void AddEntityToSystems(Entity entity);
+	void RemoveEntityFromSystems(Entity entity);
+
+	// Statistics for the performance overlay
+	int GetNumEntities() const;
+	int GetNumComponentPools() const;
+	// Returns nullptr if no component of that type was ever added
+	const IPool* GetComponentPool(int componentId) const;
+	template <typename TComponent> Pool<TComponent>* GetComponentPool() const;
 
 };
 
@@ -218,10 +266,9 @@ TSystem& Registry::GetSystem() const {
 	return *(std::static_pointer_cast<TSystem>(system->second));
 }
 
-template <typename TComponent, typename ...TArgs>
-void Registry::AddComponent(Entity entity, TArgs&& ...args) {
+template <typename TComponent>
+Pool<TComponent>* Registry::GetOrCreateComponentPool() {
 	const int componentId = Component<TComponent>::GetId();
-	const int entityId = entity.GetId();
 
 	if (componentId >= componentPools.size()) {
 		componentPools.resize(componentId + 1, nullptr);
@@ -232,7 +279,22 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args) {
 		componentPools[componentId] = newComponentPool;
 	}
 
-	std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+	return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent, typename ...TArgs>
+void Registry::AddComponent(Entity entity, TArgs&& ...args) {
+	EmplaceComponent<TComponent>(entity, std::forward<TArgs>(args)...);
+
+	MIRAGE_LOG_DEBUG("Component id: {} was added to entity id {}", Component<TComponent>::GetId(), entity.GetId());
+}
+
+template <typename TComponent, typename ...TArgs>
+void Registry::EmplaceComponent(Entity entity, TArgs&& ...args) {
+	const int componentId = Component<TComponent>::GetId();
+	const int entityId = entity.GetId();
+
+	Pool<TComponent>* componentPool = GetOrCreateComponentPool<TComponent>();
 
 	if (entityId >= componentPool->GetSize()) {
 		componentPool->Resize(activeEntities);
@@ -243,8 +305,14 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args) {
 	componentPool->Set(entityId, newComponent);
 
 	entityComponentSignatures[entityId].set(componentId);
+}
 
-	Logger::Log("Component id: " + std::to_string(componentId) + " was added to entity id " + std::to_string(entityId));
+template <typename TComponent>
+void Registry::ReserveComponents(int numEntities) {
+	Pool<TComponent>* componentPool = GetOrCreateComponentPool<TComponent>();
+	if (numEntities > componentPool->GetSize()) {
+		componentPool->Resize(numEntities);
+	}
 }
 
 template <typename TComponent>
@@ -254,7 +322,7 @@ void Registry::RemoveComponent(Entity entity) {
 
 	entityComponentSignatures[entityId].set(componentId, false);
 
-	Logger::Log("Component id: " + std::to_string(componentId) + " was removed from entity id " + std::to_string(entityId));
+	MIRAGE_LOG_DEBUG("Component id: {} was removed from entity id {}", componentId, entityId);
 }
 
 template <typename TComponent> 
@@ -269,10 +337,20 @@ template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const{
 	const int entityId = entity.GetId();
 	const int componentId = Component<TComponent>::GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+	// Raw pointer cast, copying the shared_ptr would touch its atomic refcount on every component access
+	auto componentPool = static_cast<Pool<TComponent>*>(componentPools[componentId].get());
 	return componentPool->Get(entityId);
 }
 
+template <typename TComponent>
+Pool<TComponent>* Registry::GetComponentPool() const {
+	const int componentId = Component<TComponent>::GetId();
+	if (componentId >= static_cast<int>(componentPools.size())) {
+		return nullptr;
+	}
+	return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
 template <typename TComponent, typename ...TArgs>
 void Entity::AddComponent(TArgs&& ...args) {
 	registry->AddComponent<TComponent>(*this, std::forward<TArgs>(args)...);
@@ -285,7 +363,7 @@ void Entity::RemoveComponent() {
 
 template <typename TComponent>
 bool Entity::HasComponent() const {
-	registry->HasComponent<TComponent>(*this);
+	return registry->HasComponent<TComponent>(*this);
 }
 
 template <typename TComponent>
@@ -0,0 +1,23 @@
+#include "EngineCounters.h"
+
+std::atomic<int64_t> EngineCounters::values[NUM_ENGINE_COUNTERS] = {};
+
+const char* const EngineCounters::names[NUM_ENGINE_COUNTERS] = {
+	"Sprites drawn",
+	"Draw calls",
+	"Texture switches",
+	"Simulation ticks",
+	"TransformSnapshotSystem::Update",
+	"ScriptSystem::Update",
+	"MovementSystem::Update",
+	"Registry::Update",
+	"RenderSystem::Update",
+	"Game::Update",
+	"Game::Render",
+	"Lua calls",
+	"Coroutines resumed",
+	"Coroutines running",
+	"Lua heap KB",
+	"Lua allocated KB",
+	"Lua GC us"
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Counters the engine keeps up to date for the performance overlay. Per frame counters are
+// overwritten by the code that produces them every frame.
+enum EngineCounter {
+	// Render backend, per frame
+	COUNTER_SPRITES_DRAWN,
+	COUNTER_DRAW_CALLS,
+	COUNTER_TEXTURE_SWITCHES,
+	// Simulation, per frame
+	COUNTER_SIMULATION_TICKS,
+	COUNTER_SNAPSHOT_MICROSECS,
+	COUNTER_SCRIPT_SYSTEM_MICROSECS,
+	COUNTER_MOVEMENT_SYSTEM_MICROSECS,
+	COUNTER_REGISTRY_UPDATE_MICROSECS,
+	COUNTER_RENDER_EXTRACT_MICROSECS,
+	COUNTER_UPDATE_MICROSECS,
+	COUNTER_RENDER_MICROSECS,
+	// Scripting, per frame
+	COUNTER_SCRIPT_CALLS,
+	COUNTER_COROUTINES_RESUMED,
+	COUNTER_COROUTINES_RUNNING,
+	COUNTER_LUA_HEAP_KILOBYTES,
+	COUNTER_LUA_ALLOCATED_KILOBYTES,
+	COUNTER_LUA_GC_MICROSECS,
+	NUM_ENGINE_COUNTERS
+};
+
+// Lock free counters that any thread can write and the overlay reads, relaxed atomics
+// are enough because every value is a standalone statistic
+class EngineCounters
+{
+private:
+	static std::atomic<int64_t> values[NUM_ENGINE_COUNTERS];
+	static const char* const names[NUM_ENGINE_COUNTERS];
+
+public:
+	static void Set(EngineCounter counter, int64_t value) {
+		values[counter].store(value, std::memory_order_relaxed);
+	}
+
+	static void Add(EngineCounter counter, int64_t value) {
+		values[counter].fetch_add(value, std::memory_order_relaxed);
+	}
+
+	static int64_t Get(EngineCounter counter) {
+		return values[counter].load(std::memory_order_relaxed);
+	}
+
+	static const char* GetName(EngineCounter counter) {
+		return names[counter];
+	}
+};
+
+// Adds the time spent in its scope to a counter in microseconds
+class CounterTimer
+{
+private:
+	EngineCounter counter;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	CounterTimer(EngineCounter counter): counter(counter), start(std::chrono::steady_clock::now()) {}
+
+	~CounterTimer() {
+		EngineCounters::Add(counter, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+};
@@ -0,0 +1,123 @@
+#include "FramePacer.h"
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+// Starting guess for how far a sleep overshoots, about one scheduler tick with a 1 ms timer resolution
+const std::chrono::microseconds INITIAL_SPIN_MARGIN(2000);
+const std::chrono::microseconds MAX_SPIN_MARGIN(4000);
+
+FramePacer::FramePacer(int targetFps) {
+	SetTargetFps(targetFps);
+	spinMargin = INITIAL_SPIN_MARGIN;
+	frameTimes.resize(MAX_SAMPLES);
+	sortedFrameTimes.resize(MAX_SAMPLES);
+}
+
+void FramePacer::SetTargetFps(int targetFps) {
+	if (targetFps > 0) {
+		targetFrameTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+	}
+	else {
+		targetFrameTime = Clock::duration::zero();
+	}
+	hasStarted = false;
+}
+
+void FramePacer::SleepUntil(Clock::time_point deadline) {
+	Clock::time_point now = Clock::now();
+
+	// Sleep coarsely while the remaining time is safely above the expected oversleep
+	if (deadline - now > spinMargin) {
+		Clock::time_point wakeTarget = deadline - spinMargin;
+		std::this_thread::sleep_until(wakeTarget);
+		now = Clock::now();
+
+		// Track the oversleep, grow quickly and shrink slowly
+		Clock::duration oversleep = now - wakeTarget;
+		if (oversleep > spinMargin) {
+			spinMargin = std::min<Clock::duration>(oversleep, MAX_SPIN_MARGIN);
+		}
+		else {
+			spinMargin -= (spinMargin - oversleep) / 16;
+		}
+	}
+
+	// Spin for the rest
+	while (Clock::now() < deadline) {
+	}
+}
+
+void FramePacer::WaitForNextFrame() {
+	if (!hasStarted) {
+		hasStarted = true;
+		lastFrameStart = Clock::now();
+		nextFrameStart = lastFrameStart + targetFrameTime;
+		return;
+	}
+
+	if (targetFrameTime > Clock::duration::zero()) {
+		SleepUntil(nextFrameStart);
+	}
+
+	Clock::time_point now = Clock::now();
+	RecordFrameTime(std::chrono::duration<float, std::milli>(now - lastFrameStart).count());
+	lastFrameStart = now;
+
+	// Stay on the frame grid, unless a frame ran so long that catching up would mean a burst of frames
+	nextFrameStart += targetFrameTime;
+	if (nextFrameStart < now) {
+		nextFrameStart = now + targetFrameTime;
+	}
+}
+
+void FramePacer::RecordFrameTime(float millisecs) {
+	frameTimes[nextSample] = millisecs;
+	nextSample = (nextSample + 1) % MAX_SAMPLES;
+	sampleCount = std::min(sampleCount + 1, static_cast<int>(MAX_SAMPLES));
+}
+
+// Percentile of values, reorders them
+static float Percentile(float* values, int count, double percentile) {
+	int index = std::min(count - 1, static_cast<int>(percentile * count));
+	std::nth_element(values, values + index, values + count);
+	return values[index];
+}
+
+FrameTimeStats FramePacer::GetStats() const {
+	FrameTimeStats stats = {};
+	stats.sampleCount = sampleCount;
+	if (sampleCount == 0) {
+		return stats;
+	}
+
+	float* sorted = sortedFrameTimes.data();
+	double total = 0.0;
+	for (int i = 0; i < sampleCount; i++) {
+		sorted[i] = frameTimes[i];
+		total += frameTimes[i];
+	}
+	stats.meanMillisecs = total / sampleCount;
+	stats.p50Millisecs = Percentile(sorted, sampleCount, 0.50);
+	stats.p95Millisecs = Percentile(sorted, sampleCount, 0.95);
+	stats.p99Millisecs = Percentile(sorted, sampleCount, 0.99);
+
+	double reference = stats.p50Millisecs;
+	if (targetFrameTime > Clock::duration::zero()) {
+		reference = std::chrono::duration<double, std::milli>(targetFrameTime).count();
+	}
+
+	for (int i = 0; i < sampleCount; i++) {
+		sorted[i] = static_cast<float>(std::fabs(frameTimes[i] - reference));
+	}
+	stats.jitterP50Millisecs = Percentile(sorted, sampleCount, 0.50);
+	stats.jitterP99Millisecs = Percentile(sorted, sampleCount, 0.99);
+	return stats;
+}
+
+void FramePacer::GetFrameTimes(const float*& samples, int& count, int& offset) const {
+	samples = frameTimes.data();
+	count = sampleCount;
+	// Until the ring is full the samples start at index 0
+	offset = sampleCount < MAX_SAMPLES ? 0 : nextSample;
+}
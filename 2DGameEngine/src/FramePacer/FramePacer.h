@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+// Frame times over the recent frames in milliseconds. Jitter is the distance of a frame time
+// from the target frame time, or from the median frame time when running uncapped.
+struct FrameTimeStats {
+	int sampleCount;
+	double meanMillisecs;
+	double p50Millisecs;
+	double p95Millisecs;
+	double p99Millisecs;
+	double jitterP50Millisecs;
+	double jitterP99Millisecs;
+};
+
+// Paces frames to a target rate by sleeping for most of the remaining frame time and then
+// spinning for the rest, which avoids the scheduler overshoot of sleeping the whole way.
+class FramePacer
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// Zero when uncapped
+	Clock::duration targetFrameTime;
+	Clock::time_point nextFrameStart;
+	Clock::time_point lastFrameStart;
+	bool hasStarted = false;
+
+	// How much earlier than the deadline to stop sleeping, adapted to the observed oversleep
+	Clock::duration spinMargin;
+
+	// Ring of the most recent frame times
+	std::vector<float> frameTimes;
+	// Preallocated scratch space for computing percentiles without allocating
+	mutable std::vector<float> sortedFrameTimes;
+	int sampleCount = 0;
+	int nextSample = 0;
+
+	void SleepUntil(Clock::time_point deadline);
+	void RecordFrameTime(float millisecs);
+
+public:
+	static const int MAX_SAMPLES = 1024;
+
+	// A target of 0 fps runs uncapped
+	FramePacer(int targetFps = 60);
+
+	void SetTargetFps(int targetFps);
+
+	// Blocks until the next frame is due and records the time since the previous frame
+	void WaitForNextFrame();
+
+	FrameTimeStats GetStats() const;
+
+	// The frame time ring for plotting, the oldest sample is at offset
+	void GetFrameTimes(const float*& samples, int& count, int& offset) const;
+};
@@ -3,73 +3,176 @@
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
+#include "../Components/ScriptComponent.h"
 #include "../Systems/MovementSystem.h"
 #include "../Systems/RenderSystem.h"
+#include "../Systems/ScriptSystem.h"
+#include "../Systems/TransformSnapshotSystem.h"
+#include "../LevelLoader/LevelLoader.h"
+#include "../Renderer/SDLRenderBackend.h"
+#include "../Renderer/SoftwareRenderBackend.h"
+#include "../Renderer/ImageCompare.h"
+#include "../Profiler/Profiler.h"
+#include "../EngineCounters/EngineCounters.h"
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 #include <SDL.h>
 #include <SDL_image.h>
 #include <glm/glm.hpp>
 #include "../Logger/Logger.h"
 
-Game::Game() {
+Game::Game(const GameConfig& config) {
 	isRunning = false;
+	window = nullptr;
+	renderer = nullptr;
+	offscreenSurface = nullptr;
+	capturedFrame = nullptr;
+	this->config = config;
+	framePacer.SetTargetFps(config.targetFps);
+	// Created even without scripting, levels are Lua files
+	scriptEngine = std::make_unique<ScriptEngine>("./assets/scripts");
+	scriptEngine->SetBytecodeCacheDirectory(config.scriptCacheDirectory);
 	registry = std::make_unique<Registry>();
 	assetStore = std::make_unique<AssetStore>();
-	Logger::Log("constructor called!");
+	MIRAGE_LOG_INFO("constructor called!");
 }
 
 Game::~Game() {
-	Logger::Log("destructor called!");
+	MIRAGE_LOG_INFO("destructor called!");
 }
 
 void Game::Initialize() {
-	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
-		Logger::Err("Error initializing SDL.");
+	Uint32 sdlFlags = SDL_INIT_EVERYTHING;
+	if (config.headless) {
+		// The dummy driver needs no display, audio and controllers are not needed either
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+		sdlFlags = SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS;
+	}
+
+	if (SDL_Init(sdlFlags) != 0) {
+		MIRAGE_LOG_ERROR("Error initializing SDL.");
 		return;
 	}
 
+	// Load the image decoders up front, async loads use them from several threads at once
+	if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0) {
+		MIRAGE_LOG_ERROR("Error initializing SDL_image: {}", IMG_GetError());
+	}
+
 	SDL_DisplayMode displayMode;
 	SDL_GetCurrentDisplayMode(0, &displayMode);
 
 	windowWidth = 800; //displayMode.w;
 	windowHeight = 600; //displayMode.h;
 
-	window = SDL_CreateWindow(
-		"MirageEngine",
-		SDL_WINDOWPOS_CENTERED,
-		SDL_WINDOWPOS_CENTERED,
-		windowWidth,
-		windowHeight,
-		0
-	);
+	// The software backend draws on the CPU and needs no SDL renderer at all
+	const bool useSDLRenderer = config.renderingEnabled && config.renderBackend == RENDER_BACKEND_SDL;
 
-	if (!window) {
-		Logger::Err("Error creating SDL window.");
-		return;
+	if (config.headless) {
+		if (useSDLRenderer) {
+			offscreenSurface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_RGBA32);
+			if (!offscreenSurface) {
+				MIRAGE_LOG_ERROR("Error creating offscreen surface.");
+				return;
+			}
+
+			renderer = SDL_CreateSoftwareRenderer(offscreenSurface);
+			if (!renderer) {
+				MIRAGE_LOG_ERROR("Error creating SDL software renderer.");
+				return;
+			}
+		}
+
+		MIRAGE_LOG_INFO("Running headless with the {} video driver", SDL_GetCurrentVideoDriver());
 	}
+	else {
+		window = SDL_CreateWindow(
+			"MirageEngine",
+			SDL_WINDOWPOS_CENTERED,
+			SDL_WINDOWPOS_CENTERED,
+			windowWidth,
+			windowHeight,
+			0
+		);
+
+		if (!window) {
+			MIRAGE_LOG_ERROR("Error creating SDL window.");
+			return;
+		}
 
-	SDL_SetWindowTitle(window, "AuraEngine");
+		SDL_SetWindowTitle(window, "AuraEngine");
 
-	renderer = SDL_CreateRenderer(
-		window,
-		-1,
-		SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
-	);
+		if (useSDLRenderer) {
+			Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+			if (config.vsync) {
+				rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+			}
 
-	if (!renderer) {
-		Logger::Err("Error creating SDL renderer.");
-		return;
+			renderer = SDL_CreateRenderer(window, -1, rendererFlags);
+
+			if (!renderer) {
+				MIRAGE_LOG_ERROR("Error creating SDL renderer.");
+				return;
+			}
+		}
+
+		//SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
+	}
+
+	// Decodes assets in the background and runs the software rasterizer
+	jobSystem = std::make_unique<JobSystem>();
+	assetStore->SetJobSystem(jobSystem.get());
+	if (!config.archivePath.empty()) {
+		assetStore->MountArchive(config.archivePath);
+	}
+	assetStore->SetTextureCacheDirectory(config.textureCacheDirectory);
+	assetStore->SetTextureBudget(config.textureBudgetBytes);
+	scriptEngine->SetArchive(&assetStore->GetArchive());
+	if (config.scriptingEnabled) {
+		// Parallel behaviours are updated in one Lua state per job thread
+		scriptEngine->CreateWorkerStates(jobSystem->GetNumThreads());
+	}
+	scriptEngine->SetProfilerSampleInterval(config.luaSampleInstructions);
+	scriptEngine->SetGlobal("windowWidth", windowWidth);
+	scriptEngine->SetGlobal("windowHeight", windowHeight);
+	if (config.hotReload) {
+		assetWatcher = std::make_unique<AssetWatcher>(ASSET_RELOAD_DEBOUNCE_MILLISECS);
+		if (!assetWatcher->Start("./assets")) {
+			assetWatcher.reset();
+		}
 	}
 
-	//SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
+	if (config.renderingEnabled) {
+		if (config.renderBackend == RENDER_BACKEND_SOFTWARE) {
+			// The CPU rasterizer reads texture pixels instead of SDL textures
+			assetStore->SetKeepPixels(true);
+			renderBackend = std::make_unique<SoftwareRenderBackend>(windowWidth, windowHeight, window, *assetStore, *jobSystem);
+		}
+		else {
+			renderBackend = std::make_unique<SDLRenderBackend>(renderer, *assetStore);
+
+			// ImGui draws through the SDL renderer, so the overlay is only available with this backend
+			overlay = std::make_unique<PerformanceOverlay>(renderer, windowWidth, windowHeight);
+			if (config.showOverlay) {
+				overlay->Toggle();
+			}
+		}
+	}
 
 	isRunning = true;
 }
 
 
 void Game::ProcessInput() {
+	PROFILE_SCOPE("Game::ProcessInput");
+
 	SDL_Event sdlEvent;
 	while (SDL_PollEvent(&sdlEvent)) {
+		if (overlay) {
+			overlay->ProcessEvent(sdlEvent);
+		}
+
 		switch (sdlEvent.type)
 		{
 		case SDL_QUIT:
@@ -80,6 +183,12 @@ void Game::ProcessInput() {
 			if (sdlEvent.key.keysym.sym == SDLK_ESCAPE) {
 				isRunning = false;
 			}
+			if (sdlEvent.key.keysym.sym == SDLK_F1 && overlay) {
+				overlay->Toggle();
+			}
+			if (sdlEvent.key.keysym.sym == SDLK_F9) {
+				isTraceRequested = true;
+			}
 			break;
 		}
 
@@ -88,77 +197,469 @@ void Game::ProcessInput() {
 
 void Game::LoadLevel(int levelIndex) {
 
+	registry->AddSystem<TransformSnapshotSystem>();
 	registry->AddSystem<MovementSystem>();
-	registry->AddSystem<RenderSystem>();
+	registry->AddSystem<RenderSystem>(*assetStore);
+	if (config.scriptingEnabled) {
+		registry->AddSystem<ScriptSystem>(*scriptEngine, jobSystem.get());
+	}
 
-	// Add assets to the asset store
-	assetStore->AddTexture(renderer, "tank-image-left", "./assets/images/tank-panther-right.png");
-	assetStore->AddTexture(renderer, "truck-image", "./assets/images/truck-ford-right.png");
+	// Textures, the tilemap and the entities all come from the level file
+	const std::string levelPath = "./assets/levels/level" + std::to_string(levelIndex) + ".lua";
+	LevelLoader::Load(levelPath, *scriptEngine, *registry, *assetStore, renderer);
 
-	// Load the tilemap
+	if (config.stressSprites > 0) {
+		TextureHandle truckTexture = assetStore->GetTextureHandle("truck-image");
+		if (!truckTexture.IsValid()) {
+			truckTexture = assetStore->AddTextureAsync(renderer, "truck-image", "./assets/images/truck-ford-right.png");
+		}
+		SpawnStressSprites(truckTexture, config.stressSprites);
+	}
+}
 
+void Game::SpawnStressSprites(TextureHandle texture, int count) {
+	const int endEntityId = registry->GetNumEntities() + count;
+	registry->ReserveComponents<TransformComponent>(endEntityId);
+	registry->ReserveComponents<RigidBodyComponent>(endEntityId);
+	registry->ReserveComponents<SpriteComponent>(endEntityId);
+
+	// Fixed seed so benchmark runs are comparable
+	srand(1);
+	for (Entity entity : registry->CreateEntities(count)) {
+		glm::vec2 position(rand() % windowWidth, rand() % windowHeight);
+		glm::vec2 velocity(rand() % 200 - 100, rand() % 200 - 100);
+		registry->EmplaceComponent<TransformComponent>(entity, position, glm::vec2(1.0, 1.0), rand() % 360);
+		registry->EmplaceComponent<RigidBodyComponent>(entity, velocity);
+		registry->EmplaceComponent<SpriteComponent>(entity, texture);
+	}
+	MIRAGE_LOG_INFO("Spawned {} stress test sprites", count);
+}
 
 
-	// Create entities
+void Game::Setup() {
+	LoadLevel(1);
 
-	Entity tank = registry->CreateEntity();
+	// Fixed length runs are benchmarks and image checks, they must not see placeholders
+	if (config.maxFrames > 0) {
+		assetStore->WaitForLoads(renderer);
+	}
 
-	tank.AddComponent<TransformComponent>(glm::vec2(10.0, 30.0), glm::vec2(1.0, 1.0), 0.0);
-	tank.AddComponent<RigidBodyComponent>(glm::vec2(0, 40.0));
-	tank.AddComponent<SpriteComponent>("tank-image-left");
+	// Add the entities of the level to the systems before the first tick
+	registry->Update();
 
-	Entity dickinson = registry->CreateEntity();
+	// Loading time is not simulated
+	previousUpdateCounter = SDL_GetPerformanceCounter();
+}
+
+void Game::Update() {
+	PROFILE_SCOPE("Game::Update");
+
+	Uint64 updateStart = SDL_GetPerformanceCounter();
+
+	// Advance the simulation in fixed steps so it behaves the same at any frame rate
+	const double fixedDeltaTime = 1.0 / config.tickRate;
+
+	if (config.fixedStep) {
+		// Exactly one tick per frame whatever the clock says, so every run draws the same frames
+		accumulator = fixedDeltaTime;
+	}
+	else {
+		// Real time since the last update converted to seconds
+		accumulator += static_cast<double>(updateStart - previousUpdateCounter) / SDL_GetPerformanceFrequency();
+	}
+	previousUpdateCounter = updateStart;
+	int ticks = 0;
+
+	EngineCounters::Set(COUNTER_SNAPSHOT_MICROSECS, 0);
+	EngineCounters::Set(COUNTER_SCRIPT_SYSTEM_MICROSECS, 0);
+	EngineCounters::Set(COUNTER_SCRIPT_CALLS, 0);
+	EngineCounters::Set(COUNTER_COROUTINES_RESUMED, 0);
+	EngineCounters::Set(COUNTER_MOVEMENT_SYSTEM_MICROSECS, 0);
+	EngineCounters::Set(COUNTER_REGISTRY_UPDATE_MICROSECS, 0);
+	EngineCounters::Set(COUNTER_RENDER_EXTRACT_MICROSECS, 0);
+
+	while (accumulator >= fixedDeltaTime && ticks < config.maxTicksPerFrame) {
+		PROFILE_SCOPE("Simulation tick");
+
+		{
+			CounterTimer timer(COUNTER_SNAPSHOT_MICROSECS);
+			registry->GetSystem<TransformSnapshotSystem>().Update();
+		}
+
+		// Ask all the systems to update, scripts steer before the movement is integrated
+		if (config.scriptingEnabled) {
+			CounterTimer timer(COUNTER_SCRIPT_SYSTEM_MICROSECS);
+			registry->GetSystem<ScriptSystem>().Update(fixedDeltaTime);
+		}
+		{
+			CounterTimer timer(COUNTER_MOVEMENT_SYSTEM_MICROSECS);
+			registry->GetSystem<MovementSystem>().Update(fixedDeltaTime);
+		}
+
+		// Update the registry
+		{
+			CounterTimer timer(COUNTER_REGISTRY_UPDATE_MICROSECS);
+			registry->Update();
+		}
+
+		accumulator -= fixedDeltaTime;
+		ticks++;
+	}
+	simulationTicks += ticks;
+	EngineCounters::Set(COUNTER_SIMULATION_TICKS, ticks);
 
-	dickinson.AddComponent<TransformComponent>(glm::vec2(50.0, 100.0), glm::vec2(1.0, 1.0), 0.0);
-	dickinson.AddComponent<RigidBodyComponent>(glm::vec2(70.0, 0));
-	dickinson.AddComponent<SpriteComponent>("truck-image");
+	// Spiral of death clamp, drop whatever could not be simulated this frame
+	if (accumulator >= fixedDeltaTime) {
+		accumulator = std::fmod(accumulator, fixedDeltaTime);
+	}
+
+	// Extract what has to be drawn, the render thread never touches the registry
+	if (renderBackend) {
+		CounterTimer timer(COUNTER_RENDER_EXTRACT_MICROSECS);
+		registry->GetSystem<RenderSystem>().Update(renderFrames[simulationFrameIndex], accumulator / fixedDeltaTime);
+	}
+
+	// Lua garbage is collected in a bounded slice here instead of whenever a script allocates
+	{
+		EngineCounters::Set(COUNTER_LUA_GC_MICROSECS, 0);
+		PROFILE_SCOPE("Lua GC");
+		CounterTimer timer(COUNTER_LUA_GC_MICROSECS);
+		scriptEngine->CollectGarbage(LUA_GC_BUDGET_MILLISECS);
+	}
+	EngineCounters::Set(COUNTER_LUA_HEAP_KILOBYTES, scriptEngine->GetHeapBytes() / 1024);
+	EngineCounters::Set(COUNTER_LUA_ALLOCATED_KILOBYTES, scriptEngine->TakeAllocatedBytes() / 1024);
+
+	Uint64 elapsedTicks = SDL_GetPerformanceCounter() - updateStart;
+	updateTicks += elapsedTicks;
+	EngineCounters::Set(COUNTER_UPDATE_MICROSECS, elapsedTicks * 1000000 / SDL_GetPerformanceFrequency());
 }
 
+void Game::SimulationLoop() {
+	Profiler::SetThreadName("Simulation");
 
-void Game::Setup() {
-	LoadLevel(1);
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(simulationMutex);
+			simulationWake.wait(lock, [this] {
+				return simulationRequested || simulationStopping;
+			});
+			if (simulationStopping) {
+				return;
+			}
+			simulationRequested = false;
+		}
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		Update();
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		{
+			std::lock_guard<std::mutex> lock(simulationMutex);
+			simulationStart = start;
+			simulationEnd = end;
+			simulationDone = true;
+		}
+		simulationWake.notify_all();
+	}
 }
 
-void Game::Update() {
+void Game::StartSimulation() {
+	simulationStopping = false;
+	simulationRequested = false;
+	simulationDone = true;
+	simulationThread = std::thread(&Game::SimulationLoop, this);
+}
+
+void Game::StopSimulation() {
+	WaitForSimulation();
+	{
+		std::lock_guard<std::mutex> lock(simulationMutex);
+		simulationStopping = true;
+	}
+	simulationWake.notify_all();
+	simulationThread.join();
+}
 
-	int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
-	if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME) {
-		SDL_Delay(timeToWait);
+void Game::KickSimulation() {
+	{
+		std::lock_guard<std::mutex> lock(simulationMutex);
+		simulationDone = false;
+		simulationRequested = true;
 	}
-	// The difference in ticks since the last frame converted to seconds
-	double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
+	simulationWake.notify_all();
+}
 
-	// Store current frame time
-	millisecsPreviousFrame = SDL_GetTicks();
+void Game::WaitForSimulation() {
+	PROFILE_SCOPE("Game::WaitForSimulation");
 
-	// Ask all the systems to update
-	registry->GetSystem<MovementSystem>().Update(deltaTime);
+	std::unique_lock<std::mutex> lock(simulationMutex);
+	simulationWake.wait(lock, [this] {
+		return simulationDone;
+	});
+}
 
-	// Update the registry
-	registry->Update();
+void Game::SwapRenderFrames() {
+	// The frame just simulated becomes the one to render, the simulation writes into the other one
+	renderFrameIndex = simulationFrameIndex;
+	simulationFrameIndex = 1 - simulationFrameIndex;
+}
+
+void Game::AccumulateOverlap(Uint64 renderStart, Uint64 renderEnd) {
+	// The render of frame N against the simulation of frame N + 1 that was kicked just before it
+	Uint64 overlapStart = renderStart > simulationStart ? renderStart : simulationStart;
+	Uint64 overlapEnd = renderEnd < simulationEnd ? renderEnd : simulationEnd;
+	if (overlapEnd > overlapStart) {
+		overlapTicks += overlapEnd - overlapStart;
+	}
 }
 
 
 void Game::Render() {
-	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
-	SDL_RenderClear(renderer);
+	if (!renderBackend) {
+		return;
+	}
+
+	PROFILE_SCOPE("Game::Render");
+
+	Uint64 renderStart = SDL_GetPerformanceCounter();
 
-	registry->GetSystem<RenderSystem>().Update(renderer, assetStore);
+	renderBackend->BeginFrame({ 21, 21, 21, 255 });
 
-	SDL_RenderPresent(renderer);
+	renderBackend->DrawSprites(renderFrames[renderFrameIndex].sprites);
+
+	renderBackend->EndFrame();
+
+	if (overlay && overlay->IsVisible()) {
+		overlay->Render(overlayStats, framePacer);
+	}
+
+	// Keep the last frame of a fixed length run for screenshots and golden image checks
+	const bool isLastFrame = config.maxFrames > 0 && frameCount + 1 >= config.maxFrames;
+	if (isLastFrame && (!config.screenshotPath.empty() || !config.goldenImagePath.empty())) {
+		SDL_FreeSurface(capturedFrame);
+		capturedFrame = renderBackend->ReadPixels();
+	}
+
+	{
+		PROFILE_SCOPE("IRenderBackend::Present");
+		renderBackend->Present();
+	}
+
+	lastRenderStart = renderStart;
+	lastRenderEnd = SDL_GetPerformanceCounter();
+	renderTicks += lastRenderEnd - renderStart;
+	EngineCounters::Set(COUNTER_RENDER_MICROSECS, (lastRenderEnd - renderStart) * 1000000 / SDL_GetPerformanceFrequency());
 }
 
 void Game::Run() {
+	Profiler::SetThreadName("Main");
+
 	Setup();
+
+	// Without rendering there is nothing to overlap the simulation with
+	const bool isPipelined = config.pipelinedRendering && renderBackend;
+	if (isPipelined) {
+		StartSimulation();
+		KickSimulation();
+	}
+
 	while (isRunning) {
+		{
+			PROFILE_SCOPE("FramePacer::WaitForNextFrame");
+			framePacer.WaitForNextFrame();
+		}
+
 		ProcessInput();
-		Update();
+
+		if (isPipelined) {
+			// Simulate frame N + 1 on the simulation thread while this thread renders frame N
+			WaitForSimulation();
+			if (frameCount > 0) {
+				AccumulateOverlap(lastRenderStart, lastRenderEnd);
+			}
+			ProcessAssetUploads();
+			SwapRenderFrames();
+			if (overlay && overlay->IsVisible()) {
+				CollectOverlayStats();
+			}
+			if (isTraceRequested) {
+				WriteTrace();
+			}
+			KickSimulation();
+		}
+		else {
+			ProcessAssetUploads();
+			Update();
+			SwapRenderFrames();
+			if (overlay && overlay->IsVisible()) {
+				CollectOverlayStats();
+			}
+			if (isTraceRequested) {
+				WriteTrace();
+			}
+		}
+
 		Render();
+
+		frameCount++;
+		if (frameCount == config.traceFrames) {
+			isTraceRequested = true;
+		}
+		if (config.maxFrames > 0 && frameCount >= config.maxFrames) {
+			isRunning = false;
+		}
+	}
+
+	if (isPipelined) {
+		StopSimulation();
+	}
+	// Requested on the last frame
+	if (isTraceRequested) {
+		WriteTrace();
+	}
+	LogFrameStats();
+	CheckCapturedFrame();
+}
+
+void Game::CheckCapturedFrame() {
+	if (!capturedFrame) {
+		return;
+	}
+
+	if (!config.screenshotPath.empty()) {
+		if (SDL_SaveBMP(capturedFrame, config.screenshotPath.c_str()) != 0) {
+			MIRAGE_LOG_ERROR("Error saving screenshot {}", config.screenshotPath);
+		}
+		else {
+			MIRAGE_LOG_INFO("Saved screenshot {}", config.screenshotPath);
+		}
+	}
+
+	if (config.goldenImagePath.empty()) {
+		return;
+	}
+
+	SDL_Surface* goldenImage = SDL_LoadBMP(config.goldenImagePath.c_str());
+	if (!goldenImage) {
+		MIRAGE_LOG_ERROR("Error loading golden image {}", config.goldenImagePath);
+		exitCode = 1;
+		return;
+	}
+
+	ImageDifference difference;
+	if (!CompareImages(capturedFrame, goldenImage, GOLDEN_IMAGE_CHANNEL_TOLERANCE, difference)) {
+		MIRAGE_LOG_ERROR("Golden image {} does not match the frame size", config.goldenImagePath);
+		exitCode = 1;
+	}
+	else {
+		double mismatchRatio = static_cast<double>(difference.mismatchedPixels) / difference.totalPixels;
+		std::string result = std::to_string(difference.mismatchedPixels) + " of " + std::to_string(difference.totalPixels) +
+			" pixels differ, max channel difference " + std::to_string(difference.maxChannelDifference);
+		if (mismatchRatio > config.goldenImageThreshold) {
+			MIRAGE_LOG_ERROR("Golden image check failed: {}", result);
+			exitCode = 1;
+		}
+		else {
+			MIRAGE_LOG_INFO("Golden image check passed: {}", result);
+		}
+	}
+	SDL_FreeSurface(goldenImage);
+}
+
+void Game::ProcessAssetUploads() {
+	// Only called while the simulation thread is idle, it reads texture infos while it runs
+	if (assetWatcher) {
+		changedAssetFiles.clear();
+		assetWatcher->GetChangedFiles(changedAssetFiles);
+		for (const auto& filePath : changedAssetFiles) {
+			if (assetStore->ReloadFile(renderer, filePath) > 0) {
+				MIRAGE_LOG_INFO("Reloading changed asset {}", filePath);
+			}
+		}
+	}
+	assetStore->UpdateResidency(renderer);
+	if (assetStore->GetNumPendingLoads() > 0) {
+		PROFILE_SCOPE("AssetStore::ProcessUploads");
+		assetStore->ProcessUploads(renderer, ASSET_UPLOAD_BUDGET_MILLISECS);
+	}
+}
+
+void Game::CollectOverlayStats() {
+	// Only called while the simulation thread is idle, the registry is not safe to read otherwise
+	overlayStats.entityCount = registry->GetNumEntities();
+	overlayStats.componentPoolCount = std::min(registry->GetNumComponentPools(), static_cast<int>(MAX_COMPONENTS));
+	for (int componentId = 0; componentId < overlayStats.componentPoolCount; componentId++) {
+		const IPool* pool = registry->GetComponentPool(componentId);
+		overlayStats.componentPoolSizes[componentId] = pool ? pool->GetSize() : 0;
+		overlayStats.componentPoolMemory[componentId] = pool ? pool->GetMemoryUsage() : 0;
+	}
+	overlayStats.textureCount = assetStore->GetNumTextures();
+	overlayStats.textureMemory = assetStore->GetTextureMemory();
+	overlayStats.textureBudget = assetStore->GetTextureBudget();
+	overlayStats.luaSampleCount = scriptEngine->GetNumProfilerSamples();
+	overlayStats.luaHotspotCount = scriptEngine->GetTopHotspots(overlayStats.luaHotspots, OVERLAY_LUA_HOTSPOTS);
+}
+
+void Game::WriteTrace() {
+	isTraceRequested = false;
+	Profiler::WriteChromeTrace(config.tracePath);
+	scriptEngine->LogHotspots(LUA_HOTSPOTS_LOGGED);
+}
+
+int Game::GetExitCode() const {
+	return exitCode;
+}
+
+void Game::LogFrameStats() const {
+	if (frameCount == 0) {
+		return;
+	}
+	// Average cost of the work done per frame, the frame pacing wait is not included
+	double ticksPerMillisec = SDL_GetPerformanceFrequency() / 1000.0;
+	double updateMillisecs = updateTicks / ticksPerMillisec / frameCount;
+	double renderMillisecs = renderTicks / ticksPerMillisec / frameCount;
+	MIRAGE_LOG_INFO(
+		"Ran {} frames and {} simulation ticks, average update {} ms, average render {} ms",
+		frameCount, simulationTicks, updateMillisecs, renderMillisecs
+	);
+
+	FrameTimeStats frameTimeStats = framePacer.GetStats();
+	MIRAGE_LOG_INFO(
+		"Frame time over the last {} frames: mean {} ms, p50 {} ms, p99 {} ms, jitter p50 {} ms, p99 {} ms",
+		frameTimeStats.sampleCount, frameTimeStats.meanMillisecs, frameTimeStats.p50Millisecs, frameTimeStats.p99Millisecs,
+		frameTimeStats.jitterP50Millisecs, frameTimeStats.jitterP99Millisecs
+	);
+
+	if (overlapTicks > 0) {
+		double overlapMillisecs = overlapTicks / ticksPerMillisec / frameCount;
+		MIRAGE_LOG_INFO(
+			"Simulation overlapped rendering by {} ms per frame, {}% of the render time",
+			overlapMillisecs, static_cast<int>(100.0 * overlapTicks / renderTicks)
+		);
 	}
 }
 
 void Game::Destroy() {
-	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	SDL_FreeSurface(capturedFrame);
+	capturedFrame = nullptr;
+	assetWatcher.reset();
+	overlay.reset();
+	renderBackend.reset();
+	jobSystem.reset();
+	assetStore->SetJobSystem(nullptr);
+
+	// Textures have to be destroyed before the renderer that owns them, the job system
+	// is already gone so no load can finish after this
+	assetStore->ClearAssets();
+	if (renderer) {
+		SDL_DestroyRenderer(renderer);
+	}
+	if (offscreenSurface) {
+		SDL_FreeSurface(offscreenSurface);
+	}
+	if (window) {
+		SDL_DestroyWindow(window);
+	}
+	IMG_Quit();
 	SDL_Quit();
 }
@@ -2,26 +2,164 @@
 
 #include "../ECS/ECS.h"
 #include "../AssetStore/AssetStore.h"
+#include "../JobSystem/JobSystem.h"
+#include "../Renderer/RenderBackend.h"
+#include "../FramePacer/FramePacer.h"
+#include "../PerformanceOverlay/PerformanceOverlay.h"
+#include "../AssetWatcher/AssetWatcher.h"
+#include "../Scripting/ScriptEngine.h"
+#include "../Logger/Logger.h"
 #include <SDL.h>
 #include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 const int FPS = 60;
-const int MILLISECS_PER_FRAME = 1000 / FPS;
+// Largest per channel difference to a golden image still counted as a match
+const int GOLDEN_IMAGE_CHANNEL_TOLERANCE = 16;
+// Time per frame spent uploading textures that finished loading in the background
+const double ASSET_UPLOAD_BUDGET_MILLISECS = 2.0;
+// A changed asset file is reloaded once it has not been written to for this long
+const int ASSET_RELOAD_DEBOUNCE_MILLISECS = 200;
+// Time per frame the Lua garbage collector may run at the end of the update
+const double LUA_GC_BUDGET_MILLISECS = 0.5;
+// Rows of the Lua hotspot table logged with every trace
+const int LUA_HOTSPOTS_LOGGED = 20;
+
+enum RenderBackendType {
+	RENDER_BACKEND_SDL,
+	RENDER_BACKEND_SOFTWARE
+};
+
+// Startup options, filled from the command line in Main.cpp
+struct GameConfig {
+	// Use the SDL dummy video driver and render into an offscreen surface, no window or GPU needed
+	bool headless = false;
+	// When false nothing is rendered at all, only the simulation runs
+	bool renderingEnabled = true;
+	RenderBackendType renderBackend = RENDER_BACKEND_SDL;
+	bool vsync = true;
+	// Simulate the next frame on a separate thread while the current one is rendered
+	bool pipelinedRendering = true;
+	// Frame rate the frame pacer holds, 0 runs uncapped
+	int targetFps = FPS;
+	// Simulation ticks per second, independent of the frame rate
+	int tickRate = 60;
+	// Most ticks simulated in one frame, time beyond that is dropped so a slow frame can not snowball
+	int maxTicksPerFrame = 5;
+	// Simulate exactly one tick per frame instead of following the clock, golden image checks need this
+	bool fixedStep = false;
+	// Quit after this many frames, 0 runs until the window is closed
+	int maxFrames = 0;
+	// Number of extra moving sprites spawned for benchmarking
+	int stressSprites = 0;
+	// The last frame of a --frames run is saved to this BMP file
+	std::string screenshotPath;
+	// The last frame of a --frames run is compared against this BMP file
+	std::string goldenImagePath;
+	// Fraction of pixels allowed to differ from the golden image
+	double goldenImageThreshold = 0.001;
+	// Write a profiler trace after this many frames, 0 only writes one when F9 is pressed
+	int traceFrames = 0;
+	std::string tracePath = "trace.json";
+	// Packed asset archive to load assets from, assets missing from it are loaded from loose files
+	std::string archivePath;
+	// Decoded textures are cached here so later runs skip decoding, empty disables the cache
+	std::string textureCacheDirectory = "./cache/textures";
+	// Compiled scripts are cached here so later runs skip compiling them, empty disables the cache
+	std::string scriptCacheDirectory = "./cache/scripts";
+	// Unreferenced textures are evicted once their memory exceeds this, 0 keeps every texture
+	size_t textureBudgetBytes = 0;
+	// Reload assets whose files change while the game runs, only supported on Linux.
+	// Assets in a mounted archive still load from the archive, so only loose files pick up changes.
+	bool hotReload = false;
+	// Run the Lua behaviours of scripted entities
+	bool scriptingEnabled = true;
+	// VM instructions between two samples of the Lua profiler, 0 disables it
+	int luaSampleInstructions = LUA_PROFILER_SAMPLE_INSTRUCTIONS;
+	// Show the performance overlay from the start, F1 toggles it. Needs the SDL render backend.
+	bool showOverlay = false;
+	// What logging does while the log writer is behind
+	LogOverflowPolicy logOverflowPolicy = LOG_OVERFLOW_DROP;
+	// Messages below this level are not logged, debug messages need a build that compiles them in
+	LogType logLevel = LOG_DEBUG;
+};
 
 class Game
 {
 private:
 	bool isRunning;
-	int millisecsPreviousFrame = 0;
 	SDL_Window* window;
 	SDL_Renderer* renderer;
+	// Render target of the SDL software renderer in headless mode
+	SDL_Surface* offscreenSurface;
+	// Copy of the last frame for screenshots and golden image checks
+	SDL_Surface* capturedFrame;
+	int exitCode = 0;
+
+	GameConfig config;
+	FramePacer framePacer;
+	int frameCount = 0;
+	int simulationTicks = 0;
+	// Real time not simulated yet, in seconds
+	double accumulator = 0.0;
+	Uint64 previousUpdateCounter = 0;
+	Uint64 updateTicks = 0;
+	Uint64 renderTicks = 0;
 
+	// Double buffered draw commands, the simulation fills one while the other is rendered
+	RenderFrame renderFrames[2];
+	int simulationFrameIndex = 0;
+	int renderFrameIndex = 1;
+
+	// Simulation thread, all SDL video and render calls stay on the thread running Game::Run
+	std::thread simulationThread;
+	std::mutex simulationMutex;
+	std::condition_variable simulationWake;
+	bool simulationRequested = false;
+	bool simulationDone = true;
+	bool simulationStopping = false;
+
+	// Timestamps of the last simulated and rendered frames to measure how much they overlap
+	Uint64 simulationStart = 0;
+	Uint64 simulationEnd = 0;
+	Uint64 lastRenderStart = 0;
+	Uint64 lastRenderEnd = 0;
+	Uint64 overlapTicks = 0;
+
+	// Declared before the registry, the script system keeps a reference to it
+	std::unique_ptr<ScriptEngine> scriptEngine;
 	std::unique_ptr<Registry> registry;
 	std::unique_ptr<AssetStore> assetStore;
+	std::unique_ptr<JobSystem> jobSystem;
+	std::unique_ptr<IRenderBackend> renderBackend;
+	std::unique_ptr<PerformanceOverlay> overlay;
+	OverlayStats overlayStats = {};
+	// Only created with hot reload enabled
+	std::unique_ptr<AssetWatcher> assetWatcher;
+	std::vector<std::string> changedAssetFiles;
+	// Set by F9 and --trace-frames, the trace is written once the simulation thread is idle
+	bool isTraceRequested = false;
 
+	void SimulationLoop();
+	void StartSimulation();
+	void StopSimulation();
+	void KickSimulation();
+	void WaitForSimulation();
+	void SwapRenderFrames();
+	void AccumulateOverlap(Uint64 renderStart, Uint64 renderEnd);
+	void CheckCapturedFrame();
+	void CollectOverlayStats();
+	void ProcessAssetUploads();
+	// Writes the profiler trace and the Lua hotspots, only while the simulation thread is idle
+	void WriteTrace();
+	void SpawnStressSprites(TextureHandle texture, int count);
+	void LogFrameStats() const;
 
 public:
-	Game();
+	Game(const GameConfig& config = GameConfig());
 	~Game();
 	void Initialize();
 	void Run();
@@ -31,9 +169,10 @@ public:
 	void Update();
 	void Render();
 	void Destroy();
+	// Non zero when a golden image check failed
+	int GetExitCode() const;
 
 	int windowWidth;
 	int windowHeight;
 
 };
-
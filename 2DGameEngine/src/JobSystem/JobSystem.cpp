@@ -0,0 +1,145 @@
+#include "JobSystem.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <string>
+#include <algorithm>
+
+JobSystem::JobSystem(int numWorkers) {
+	if (numWorkers < 0) {
+		int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+		numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	for (int i = 0; i < numWorkers; i++) {
+		// Index 0 belongs to the thread calling ParallelFor
+		workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+	}
+
+	MIRAGE_LOG_INFO("JobSystem started with {} worker threads", numWorkers);
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isShuttingDown = true;
+	}
+	workAvailable.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+int JobSystem::GetNumThreads() const {
+	return static_cast<int>(workers.size()) + 1;
+}
+
+void JobSystem::WorkerLoop(int workerIndex) {
+	Profiler::SetThreadName("Worker " + std::to_string(workerIndex));
+
+	while (true) {
+		ParallelJob* parallelJob;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			workAvailable.wait(lock, [&] {
+				return isShuttingDown || FindParallelJob() || !tasks.empty();
+			});
+
+			if (isShuttingDown) {
+				return;
+			}
+
+			parallelJob = FindParallelJob();
+			if (!parallelJob) {
+				std::function<void()> task = std::move(tasks.front());
+				tasks.pop_front();
+				lock.unlock();
+
+				task();
+				continue;
+			}
+
+			// Keeps the job alive, ParallelFor does not return while this worker is inside
+			parallelJob->activeWorkers++;
+		}
+
+		RunParallelJob(*parallelJob, workerIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			parallelJob->activeWorkers--;
+		}
+		workDone.notify_all();
+	}
+}
+
+JobSystem::ParallelJob* JobSystem::FindParallelJob() const {
+	for (ParallelJob* parallelJob : parallelJobs) {
+		if (parallelJob->nextIndex.load() < parallelJob->count) {
+			return parallelJob;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::RunParallelJob(ParallelJob& parallelJob, int workerIndex) {
+	while (true) {
+		int index = parallelJob.nextIndex.fetch_add(1);
+		if (index >= parallelJob.count) {
+			return;
+		}
+
+		(*parallelJob.job)(index, workerIndex);
+		parallelJob.remaining.fetch_sub(1);
+	}
+}
+
+void JobSystem::ParallelFor(int count, const std::function<void(int index, int workerIndex)>& job) {
+	if (count <= 0) {
+		return;
+	}
+
+	// Not worth waking anybody up
+	if (count == 1 || workers.empty()) {
+		for (int index = 0; index < count; index++) {
+			job(index, 0);
+		}
+		return;
+	}
+
+	ParallelJob parallelJob;
+	parallelJob.job = &job;
+	parallelJob.count = count;
+	parallelJob.nextIndex = 0;
+	parallelJob.remaining = count;
+	parallelJob.activeWorkers = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		parallelJobs.push_back(&parallelJob);
+	}
+	workAvailable.notify_all();
+
+	RunParallelJob(parallelJob, 0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	workDone.wait(lock, [&] {
+		return parallelJob.activeWorkers == 0 && parallelJob.remaining.load() == 0;
+	});
+
+	// Workers that wake up late do not find it anymore
+	parallelJobs.erase(std::find(parallelJobs.begin(), parallelJobs.end(), &parallelJob));
+}
+
+void JobSystem::Submit(std::function<void()> task) {
+	// Nobody else would ever run it
+	if (workers.empty()) {
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+	workAvailable.notify_one();
+}
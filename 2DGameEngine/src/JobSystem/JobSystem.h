@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <deque>
+
+// A fixed pool of worker threads for data parallel work and background tasks.
+// ParallelFor can be called from any thread, concurrent calls share the workers and every calling thread
+// takes part in its own work. Submit can be called from any thread.
+class JobSystem
+{
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable workDone;
+	bool isShuttingDown = false;
+
+	// State of one ParallelFor call, it lives on the stack of the calling thread
+	struct ParallelJob {
+		const std::function<void(int, int)>* job;
+		int count;
+		std::atomic<int> nextIndex;
+		// Indices not finished yet
+		std::atomic<int> remaining;
+		// Workers inside the job, guarded by the mutex. The call does not return before it dropped to 0.
+		int activeWorkers;
+	};
+
+	// Parallel for calls in progress, oldest first, guarded by the mutex. The render and simulation threads
+	// both run parallel loops.
+	std::vector<ParallelJob*> parallelJobs;
+
+	// Background tasks, guarded by the mutex. A parallel for is picked up before any queued task.
+	std::deque<std::function<void()>> tasks;
+
+	void WorkerLoop(int workerIndex);
+	// Returns a parallel job with indices left to pick up, caller holds the mutex
+	ParallelJob* FindParallelJob() const;
+	void RunParallelJob(ParallelJob& parallelJob, int workerIndex);
+
+public:
+	// A negative worker count uses one worker per hardware thread besides the calling thread
+	JobSystem(int numWorkers = -1);
+	~JobSystem();
+
+	// Number of threads taking part in a ParallelFor, worker indices are in [0, GetNumThreads())
+	int GetNumThreads() const;
+
+	// Runs job(index, workerIndex) for every index in [0, count) and returns once all of them are done.
+	// The calling thread always has worker index 0. Within one call no two threads share a worker index,
+	// so per worker state indexed by it needs no locking.
+	void ParallelFor(int count, const std::function<void(int index, int workerIndex)>& job);
+
+	// Queues a task to run on a worker thread and returns immediately.
+	// Tasks still queued when the job system is destroyed are dropped.
+	void Submit(std::function<void()> task);
+};
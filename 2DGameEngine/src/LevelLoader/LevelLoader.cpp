@@ -0,0 +1,216 @@
+#include "LevelLoader.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/ScriptComponent.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+// Tile indices of a tilemap, row by row
+struct Tilemap {
+	std::vector<int> tiles;
+	int columns = 0;
+	int rows = 0;
+};
+
+static glm::vec2 ReadVec2(const sol::table& table, const char* key, const glm::vec2& defaultValue) {
+	sol::optional<sol::table> vector = table[key];
+	if (!vector) {
+		return defaultValue;
+	}
+	return glm::vec2(vector->get_or("x", defaultValue.x), vector->get_or("y", defaultValue.y));
+}
+
+// Parses comma separated rows of tile indices, from the archive if it has the file
+static bool ReadTilemap(const std::string& filePath, const AssetStore& assetStore, Tilemap& tilemap) {
+	std::string contents;
+	const uint8_t* archiveData;
+	size_t archiveSize;
+	if (assetStore.GetArchive().Find(filePath, archiveData, archiveSize)) {
+		contents.assign(reinterpret_cast<const char*>(archiveData), archiveSize);
+	}
+	else {
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file) {
+			MIRAGE_LOG_ERROR("Error opening tilemap {}", filePath);
+			return false;
+		}
+		contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	const char* position = contents.c_str();
+	int column = 0;
+	while (*position) {
+		// Separators and line ends are skipped here, strtol would skip line ends itself
+		if (!isdigit(static_cast<unsigned char>(*position))) {
+			// A line end finishes a row
+			if (*position == '\n' && column > 0) {
+				if (tilemap.columns == 0) {
+					tilemap.columns = column;
+				}
+				else if (column != tilemap.columns) {
+					MIRAGE_LOG_ERROR("Error reading tilemap {}: row {} has a different length", filePath, tilemap.rows + 1);
+					return false;
+				}
+				tilemap.rows++;
+				column = 0;
+			}
+			position++;
+			continue;
+		}
+		char* end;
+		long tile = strtol(position, &end, 10);
+		tilemap.tiles.push_back(static_cast<int>(tile));
+		column++;
+		position = end;
+	}
+	// The last row may lack a line end
+	if (column > 0) {
+		if (tilemap.columns != 0 && column != tilemap.columns) {
+			MIRAGE_LOG_ERROR("Error reading tilemap {}: the last row has a different length", filePath);
+			return false;
+		}
+		tilemap.columns = column;
+		tilemap.rows++;
+	}
+	return true;
+}
+
+int LevelLoader::Load(const std::string& filePath, ScriptEngine& scriptEngine, Registry& registry, AssetStore& assetStore, SDL_Renderer* renderer) {
+	PROFILE_SCOPE("LevelLoader::Load");
+
+	sol::load_result chunk = scriptEngine.LoadScript(filePath);
+	if (!chunk.valid()) {
+		sol::error error = chunk;
+		MIRAGE_LOG_ERROR("Error loading level {}: {}", filePath, error.what());
+		return -1;
+	}
+	sol::protected_function levelFunction = chunk;
+	sol::protected_function_result result = levelFunction();
+	if (!result.valid()) {
+		sol::error error = result;
+		MIRAGE_LOG_ERROR("Error running level {}: {}", filePath, error.what());
+		return -1;
+	}
+	if (result.get_type() != sol::type::table) {
+		MIRAGE_LOG_ERROR("Level {} does not return a table", filePath);
+		return -1;
+	}
+	sol::table level = result;
+
+	// Queue every texture before creating anything, the worker threads decode them while the entities are built
+	std::unordered_map<std::string, TextureHandle> textures;
+	sol::optional<sol::table> textureList = level["assets"]["textures"];
+	if (textureList) {
+		for (const auto& item : *textureList) {
+			sol::table texture = item.second;
+			const std::string id = texture.get_or<std::string>("id", "");
+			const std::string file = texture.get_or<std::string>("file", "");
+			if (id.empty() || file.empty()) {
+				MIRAGE_LOG_ERROR("Level {} has a texture without an id or file", filePath);
+				continue;
+			}
+			textures[id] = assetStore.AddTextureAsync(renderer, id, file);
+		}
+	}
+	auto findTexture = [&](const std::string& id) {
+		auto texture = textures.find(id);
+		if (texture == textures.end()) {
+			MIRAGE_LOG_ERROR("Level {} uses the unknown texture {}", filePath, id);
+			return TextureHandle();
+		}
+		return texture->second;
+	};
+
+	Tilemap tilemap;
+	TextureHandle tileTexture;
+	int tileSize = 0;
+	int textureColumns = 1;
+	double tileScale = 1.0;
+	sol::optional<sol::table> tilemapTable = level["tilemap"];
+	if (tilemapTable) {
+		tileTexture = findTexture(tilemapTable->get_or<std::string>("texture", ""));
+		tileSize = tilemapTable->get_or("tileSize", 32);
+		textureColumns = std::max(1, tilemapTable->get_or("textureColumns", 1));
+		tileScale = tilemapTable->get_or("scale", 1.0);
+		if (!ReadTilemap(tilemapTable->get_or<std::string>("file", ""), assetStore, tilemap)) {
+			tilemap = Tilemap();
+		}
+	}
+
+	std::vector<sol::table> entityTables;
+	sol::optional<sol::table> entityList = level["entities"];
+	if (entityList) {
+		entityTables.reserve(entityList->size());
+		for (const auto& item : *entityList) {
+			if (item.second.get_type() == sol::type::table) {
+				entityTables.push_back(item.second.as<sol::table>());
+			}
+		}
+	}
+
+	// Grow every pool once, entity ids are consecutive from here on
+	const int numTiles = static_cast<int>(tilemap.tiles.size());
+	const int numEntities = numTiles + static_cast<int>(entityTables.size());
+	const int endEntityId = registry.GetNumEntities() + numEntities;
+	registry.ReserveComponents<TransformComponent>(endEntityId);
+	registry.ReserveComponents<SpriteComponent>(endEntityId);
+	registry.ReserveComponents<RigidBodyComponent>(endEntityId);
+	registry.ReserveComponents<ScriptComponent>(endEntityId);
+	std::vector<Entity> entities = registry.CreateEntities(numEntities);
+
+	// Tiles come first so they are drawn below everything else
+	const double tileExtent = tileSize * tileScale;
+	for (int i = 0; i < numTiles; i++) {
+		const int tile = tilemap.tiles[i];
+		const glm::vec2 position((i % tilemap.columns) * tileExtent, (i / tilemap.columns) * tileExtent);
+		registry.EmplaceComponent<TransformComponent>(entities[i], position, glm::vec2(tileScale, tileScale), 0.0);
+		registry.EmplaceComponent<SpriteComponent>(entities[i], tileTexture, tileSize, tileSize, (tile % textureColumns) * tileSize, (tile / textureColumns) * tileSize);
+	}
+
+	for (size_t i = 0; i < entityTables.size(); i++) {
+		const Entity entity = entities[numTiles + i];
+		sol::optional<sol::table> components = entityTables[i]["components"];
+		if (!components) {
+			continue;
+		}
+
+		sol::optional<sol::table> transform = (*components)["transform"];
+		if (transform) {
+			registry.EmplaceComponent<TransformComponent>(entity,
+				ReadVec2(*transform, "position", glm::vec2(0, 0)),
+				ReadVec2(*transform, "scale", glm::vec2(1, 1)),
+				transform->get_or("rotation", 0.0));
+		}
+
+		sol::optional<sol::table> rigidBody = (*components)["rigidbody"];
+		if (rigidBody) {
+			registry.EmplaceComponent<RigidBodyComponent>(entity, ReadVec2(*rigidBody, "velocity", glm::vec2(0, 0)));
+		}
+
+		sol::optional<sol::table> sprite = (*components)["sprite"];
+		if (sprite) {
+			const glm::vec2 srcRect = ReadVec2(*sprite, "srcRect", glm::vec2(0, 0));
+			registry.EmplaceComponent<SpriteComponent>(entity,
+				findTexture(sprite->get_or<std::string>("texture", "")),
+				sprite->get_or("width", 0),
+				sprite->get_or("height", 0),
+				static_cast<int>(srcRect.x),
+				static_cast<int>(srcRect.y));
+		}
+
+		sol::optional<sol::table> script = (*components)["script"];
+		if (script) {
+			registry.EmplaceComponent<ScriptComponent>(entity, script->get_or<std::string>("behaviour", ""));
+		}
+	}
+
+	MIRAGE_LOG_INFO("Loaded level {} with {} tiles and {} entities", filePath, numTiles, entityTables.size());
+	return numEntities;
+}
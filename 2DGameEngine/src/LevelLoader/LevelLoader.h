@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <SDL.h>
+#include "../ECS/ECS.h"
+#include "../AssetStore/AssetStore.h"
+#include "../Scripting/ScriptEngine.h"
+
+// Loads levels from Lua files returning a table of assets, a tilemap and entities, see assets/levels/level1.lua.
+// All textures are queued for background loading first. The entities are then created in one batch, with
+// every component pool grown once up front and no log line per entity or component.
+class LevelLoader
+{
+public:
+	// Returns the number of entities created, -1 if the level file can not be loaded
+	static int Load(const std::string& filePath, ScriptEngine& scriptEngine, Registry& registry, AssetStore& assetStore, SDL_Renderer* renderer);
+};
@@ -5,30 +5,317 @@
 #include <ctime>
 #include <chrono>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <cstdio>
 
-std::vector<LogEntry> Logger::messages;
+namespace {
 
-std::string CurrentDateTimeToString() {
-	std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-	std::string output(30, '\0');
-	std::strftime(&output[0], output.size(), "%d-%b-%Y %H:%M:%S", std::localtime(&now));
-	return output;
+	typedef std::chrono::system_clock::time_point LogTime;
+
+	// The sequence tells the state of a slot: equal to the position it is free for the producer writing
+	// that position, one past it the message is ready for the writer.
+	struct LogSlot {
+		std::atomic<uint64_t> sequence;
+		LogType type;
+		LogTime time;
+		const char* format;
+		LogArgument arguments[LOGGER_MAX_ARGUMENTS];
+		int numArguments;
+		// Copies of the string arguments, which point into it. Reused, so the slot keeps its capacity and
+		// logging stops allocating once warm.
+		std::string text;
+	};
+
+	LogSlot slots[LOGGER_QUEUE_SIZE];
+	std::atomic<uint64_t> enqueuePosition;
+	// Only touched by the writer
+	uint64_t dequeuePosition = 0;
+
+	std::atomic<bool> isRunning(false);
+	LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_DROP;
+	std::atomic<uint64_t> numDropped(0);
+	// Dropped messages the writer has already reported
+	uint64_t numDroppedReported = 0;
+
+	std::thread writerThread;
+	std::mutex writerMutex;
+	// Wakes the writer early, when stopping or when a blocked caller waits for room
+	std::condition_variable writerWake;
+	bool isStopping = false;
+
+	// Guards the console output and the history, the writer and the synchronous path both write
+	std::mutex outputMutex;
+	std::deque<LogEntry> history;
+	// Formatted message, reused by every entry. Guarded by the output mutex.
+	std::string formatted;
+	// Messages come in bursts within the same second, the time string only changes once per second.
+	// Guarded by the output mutex.
+	std::time_t cachedSecond = -1;
+	std::string cachedTime;
+
+	const char* const LOG_PREFIXES[] = { "DBG", "LOG", "WRN", "ERR" };
+	const char* const LOG_COLORS[] = { "\x1B[90m", "\x1B[32m", "\x1B[93m", "\x1B[91m" };
+
+	// Caller holds the output mutex
+	const std::string& TimeToString(LogTime time) {
+		const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+		if (seconds != cachedSecond) {
+			char output[32];
+			const size_t length = std::strftime(output, sizeof(output), "%d-%b-%Y %H:%M:%S", std::localtime(&seconds));
+			cachedTime.assign(output, length);
+			cachedSecond = seconds;
+		}
+		return cachedTime;
+	}
+
+	void AppendArgument(std::string& output, const LogArgument& argument) {
+		char number[32];
+		switch (argument.type) {
+		case LOG_ARGUMENT_BOOL:
+			output += argument.integer ? "true" : "false";
+			return;
+		case LOG_ARGUMENT_CHARACTER:
+			output += static_cast<char>(argument.integer);
+			return;
+		case LOG_ARGUMENT_INTEGER:
+			snprintf(number, sizeof(number), "%lld", argument.integer);
+			break;
+		case LOG_ARGUMENT_UNSIGNED:
+			snprintf(number, sizeof(number), "%llu", argument.unsignedInteger);
+			break;
+		case LOG_ARGUMENT_NUMBER:
+			snprintf(number, sizeof(number), "%g", argument.number);
+			break;
+		case LOG_ARGUMENT_POINTER:
+			snprintf(number, sizeof(number), "%p", argument.pointer);
+			break;
+		case LOG_ARGUMENT_STRING:
+			output.append(argument.text.data, argument.text.length);
+			return;
+		}
+		output += number;
+	}
+
+	// Replaces every {} with the next argument, placeholders without an argument are kept
+	void FormatMessage(std::string& output, const char* format, const LogArgument* arguments, int numArguments) {
+		output.clear();
+		int nextArgument = 0;
+		for (const char* character = format; *character; character++) {
+			if (character[0] == '{' && character[1] == '}' && nextArgument < numArguments) {
+				AppendArgument(output, arguments[nextArgument++]);
+				character++;
+			}
+			else {
+				output += *character;
+			}
+		}
+	}
+
+	// Caller holds the output mutex
+	void WriteEntry(LogType type, LogTime time, const std::string& message) {
+		LogEntry logEntry;
+		logEntry.type = type;
+		logEntry.message = std::string(LOG_PREFIXES[type]) + " | [" + TimeToString(time) + " ]" + " - " + message;
+		// Warnings and errors go to stderr
+		std::ostream& stream = type >= LOG_WARNING ? std::cerr : std::cout;
+		stream << LOG_COLORS[type] << logEntry.message << "\033[0m" << '\n';
+
+		history.push_back(std::move(logEntry));
+		if (history.size() > static_cast<size_t>(LOGGER_HISTORY_SIZE)) {
+			history.pop_front();
+		}
+	}
+
+	void WriteNow(LogType type, const char* format, const LogArgument* arguments, int numArguments) {
+		std::lock_guard<std::mutex> lock(outputMutex);
+		FormatMessage(formatted, format, arguments, numArguments);
+		WriteEntry(type, std::chrono::system_clock::now(), formatted);
+		std::cout.flush();
+	}
+
+	// Copies the arguments into the slot, strings into its text
+	void FillSlot(LogSlot& slot, LogType type, LogTime time, const char* format, const LogArgument* arguments, int numArguments) {
+		slot.type = type;
+		slot.time = time;
+		slot.format = format;
+		slot.numArguments = numArguments;
+
+		// Reserved up front so appending never moves the text the arguments point into
+		size_t textLength = 0;
+		for (int index = 0; index < numArguments; index++) {
+			if (arguments[index].type == LOG_ARGUMENT_STRING) {
+				textLength += arguments[index].text.length;
+			}
+		}
+		slot.text.clear();
+		slot.text.reserve(textLength);
+
+		for (int index = 0; index < numArguments; index++) {
+			slot.arguments[index] = arguments[index];
+			if (arguments[index].type == LOG_ARGUMENT_STRING) {
+				const size_t offset = slot.text.size();
+				slot.text.append(arguments[index].text.data, arguments[index].text.length);
+				slot.arguments[index].text.data = slot.text.data() + offset;
+			}
+		}
+	}
+
+	// Returns false if the queue is full
+	bool TryEnqueue(LogType type, LogTime time, const char* format, const LogArgument* arguments, int numArguments) {
+		uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+		while (true) {
+			LogSlot& slot = slots[position % LOGGER_QUEUE_SIZE];
+			const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+			const int64_t difference = static_cast<int64_t>(sequence - position);
+
+			if (difference == 0) {
+				// Claims the position, another producer may have taken it first
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					FillSlot(slot, type, time, format, arguments, numArguments);
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0) {
+				// The writer has not consumed the message written here one lap ago
+				return false;
+			}
+			else {
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Writes every message queued so far, returns the number written
+	int Drain() {
+		int numWritten = 0;
+		std::lock_guard<std::mutex> lock(outputMutex);
+
+		while (true) {
+			LogSlot& slot = slots[dequeuePosition % LOGGER_QUEUE_SIZE];
+			if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+				break;
+			}
+			FormatMessage(formatted, slot.format, slot.arguments, slot.numArguments);
+			WriteEntry(slot.type, slot.time, formatted);
+			// Frees the slot for the producer one lap ahead
+			slot.sequence.store(dequeuePosition + LOGGER_QUEUE_SIZE, std::memory_order_release);
+			dequeuePosition++;
+			numWritten++;
+		}
+
+		const uint64_t dropped = numDropped.load(std::memory_order_relaxed);
+		if (dropped != numDroppedReported) {
+			WriteEntry(LOG_ERROR, std::chrono::system_clock::now(), std::to_string(dropped - numDroppedReported) + " log messages dropped, the queue was full");
+			numDroppedReported = dropped;
+		}
+
+		// One flush per batch instead of one per message
+		if (numWritten > 0) {
+			std::cout.flush();
+		}
+		return numWritten;
+	}
+
+	void WriterLoop() {
+		std::unique_lock<std::mutex> lock(writerMutex);
+		while (!isStopping) {
+			lock.unlock();
+			Drain();
+			lock.lock();
+			writerWake.wait_for(lock, std::chrono::milliseconds(LOGGER_FLUSH_MILLISECS));
+		}
+	}
+
+	void Enqueue(LogType type, const char* format, const LogArgument* arguments, int numArguments) {
+		if (!isRunning.load(std::memory_order_acquire)) {
+			WriteNow(type, format, arguments, numArguments);
+			return;
+		}
+
+		const LogTime time = std::chrono::system_clock::now();
+		while (!TryEnqueue(type, time, format, arguments, numArguments)) {
+			if (overflowPolicy == LOG_OVERFLOW_DROP) {
+				numDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			writerWake.notify_one();
+			std::this_thread::yield();
+		}
+	}
+
+	// A writer thread still running when the program exits would terminate it
+	struct StopAtExit {
+		~StopAtExit() {
+			Logger::Stop();
+		}
+	} stopAtExit;
 }
 
-void Logger::Log(const std::string& message) {
+// Debug messages that were compiled in are shown unless the level is raised
+std::atomic<int> Logger::level(LOG_DEBUG);
+
+void Logger::Start(LogOverflowPolicy policy) {
+	if (isRunning) {
+		return;
+	}
 
-	LogEntry logEntry;
-	logEntry.type = LOG_INFO;
-	logEntry.message = "LOG | [" + CurrentDateTimeToString() + " ]" + " - " + message;
-	std::cout << "\x1B[32m" << logEntry.message << "\033[0m" << std::endl;
-	messages.push_back(logEntry);
+	for (int index = 0; index < LOGGER_QUEUE_SIZE; index++) {
+		slots[index].sequence.store(dequeuePosition + index, std::memory_order_relaxed);
+	}
+	enqueuePosition.store(dequeuePosition, std::memory_order_relaxed);
+	overflowPolicy = policy;
+	isStopping = false;
+	writerThread = std::thread(&WriterLoop);
+	isRunning.store(true, std::memory_order_release);
+}
+
+void Logger::Stop() {
+	if (!isRunning) {
+		return;
+	}
+
+	// Messages logged from here on are written right away
+	isRunning.store(false, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		isStopping = true;
+	}
+	writerWake.notify_one();
+	writerThread.join();
+
+	// Whatever was queued after the last drain of the writer
+	Drain();
+}
+
+void Logger::Log(const std::string& message) {
+	Write(LOG_INFO, "{}", message);
 }
 
 void Logger::Err(const std::string& message) {
+	Write(LOG_ERROR, "{}", message);
+}
+
+void Logger::SetLevel(LogType level) {
+	Logger::level.store(level, std::memory_order_relaxed);
+}
 
-	LogEntry logEntry;
-	logEntry.type = LOG_ERROR;
-	logEntry.message = "ERR | [" + CurrentDateTimeToString() + " ]" + " - " + message;
-	std::cerr << "\x1B[91m" << logEntry.message << "\033[0m" << std::endl;
-	messages.push_back(logEntry);
-}
\ No newline at end of file
+void Logger::WriteArguments(LogType type, const char* format, const LogArgument* arguments, int numArguments) {
+	if (!IsEnabled(type)) {
+		return;
+	}
+	Enqueue(type, format, arguments, numArguments);
+}
+
+std::vector<LogEntry> Logger::GetHistory() {
+	std::lock_guard<std::mutex> lock(outputMutex);
+	return std::vector<LogEntry>(history.begin(), history.end());
+}
+
+uint64_t Logger::GetNumDropped() {
+	return numDropped.load(std::memory_order_relaxed);
+}
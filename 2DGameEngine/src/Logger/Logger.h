@@ -1,24 +1,178 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
 
+// Messages the logger queue holds, a power of two
+const int LOGGER_QUEUE_SIZE = 4096;
+// Messages kept for the console, older ones are dropped
+const int LOGGER_HISTORY_SIZE = 1000;
+// Longest time a queued message waits for the writer thread
+const int LOGGER_FLUSH_MILLISECS = 5;
+// Most arguments a formatted message can have
+const int LOGGER_MAX_ARGUMENTS = 8;
+
+// Messages below this level are compiled out, 0 debug, 1 info, 2 warning, 3 error. Define it in the
+// preprocessor definitions to override the default of showing debug messages in debug builds only.
+#ifndef MIRAGE_LOG_LEVEL
+#ifdef _DEBUG
+#define MIRAGE_LOG_LEVEL 0
+#else
+#define MIRAGE_LOG_LEVEL 1
+#endif
+#endif
+
+// Ordered by severity, the values match MIRAGE_LOG_LEVEL
 enum LogType {
+	LOG_DEBUG,
 	LOG_INFO,
 	LOG_WARNING,
 	LOG_ERROR
 };
 
+// What a full queue does with another message
+enum LogOverflowPolicy {
+	// The message is dropped and counted, logging never waits for the writer
+	LOG_OVERFLOW_DROP,
+	// The caller waits until the writer made room
+	LOG_OVERFLOW_BLOCK
+};
+
 struct LogEntry {
 	LogType type;
 	std::string message;
 };
 
+enum LogArgumentType {
+	LOG_ARGUMENT_BOOL,
+	LOG_ARGUMENT_CHARACTER,
+	LOG_ARGUMENT_INTEGER,
+	LOG_ARGUMENT_UNSIGNED,
+	LOG_ARGUMENT_NUMBER,
+	LOG_ARGUMENT_POINTER,
+	LOG_ARGUMENT_STRING
+};
+
+// An argument of a formatted message, captured as is and only formatted by the writer thread
+struct LogArgument {
+	LogArgumentType type;
+	union {
+		long long integer;
+		unsigned long long unsignedInteger;
+		double number;
+		const void* pointer;
+		// Points at the caller's string while logging, at the copy in the queue afterwards
+		struct {
+			const char* data;
+			size_t length;
+		} text;
+	};
+};
+
+template <typename T>
+struct LogArgumentUnsupported : std::false_type {};
+
+template <typename T>
+LogArgument MakeLogArgument(const T& value) {
+	LogArgument argument;
+	if constexpr (std::is_same_v<T, bool>) {
+		argument.type = LOG_ARGUMENT_BOOL;
+		argument.integer = value ? 1 : 0;
+	}
+	else if constexpr (std::is_same_v<T, char>) {
+		argument.type = LOG_ARGUMENT_CHARACTER;
+		argument.integer = value;
+	}
+	else if constexpr (std::is_enum_v<T> || (std::is_integral_v<T> && std::is_signed_v<T>)) {
+		argument.type = LOG_ARGUMENT_INTEGER;
+		argument.integer = static_cast<long long>(value);
+	}
+	else if constexpr (std::is_integral_v<T>) {
+		argument.type = LOG_ARGUMENT_UNSIGNED;
+		argument.unsignedInteger = static_cast<unsigned long long>(value);
+	}
+	else if constexpr (std::is_floating_point_v<T>) {
+		argument.type = LOG_ARGUMENT_NUMBER;
+		argument.number = static_cast<double>(value);
+	}
+	else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+		std::string_view text;
+		if constexpr (std::is_pointer_v<T>) {
+			// A string view of a null pointer is undefined
+			text = value ? std::string_view(value) : std::string_view("(null)");
+		}
+		else {
+			text = value;
+		}
+		argument.type = LOG_ARGUMENT_STRING;
+		argument.text.data = text.data();
+		argument.text.length = text.size();
+	}
+	else if constexpr (std::is_pointer_v<T>) {
+		argument.type = LOG_ARGUMENT_POINTER;
+		argument.pointer = value;
+	}
+	else {
+		static_assert(LogArgumentUnsupported<T>::value, "log arguments have to be numbers, strings or pointers");
+	}
+	return argument;
+}
+
+// Log, Err and Write only queue the message, a background thread formats it, adds the timestamp, writes it to
+// the console and keeps it in the history. The queue is a lock free ring buffer any number of threads can log into. Before
+// Start and after Stop messages are written right away on the calling thread instead.
 class Logger
 {
 public:
-	static std::vector<LogEntry> messages;
+	static void Start(LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_DROP);
+	// Writes every queued message and joins the writer thread. Other threads should be done logging.
+	static void Stop();
+
+	// Messages that are already built, the MIRAGE_LOG macros avoid building ones that end up filtered out
 	static void Log(const std::string& message);
 	static void Err(const std::string& message);
+
+	// Messages below the level are dropped, compiled out levels stay out
+	static void SetLevel(LogType level);
+	static bool IsEnabled(LogType type) {
+		return type >= level.load(std::memory_order_relaxed);
+	}
+
+	// Queues the format string and the raw arguments, the writer thread replaces every {} in the format with
+	// the next argument. The format has to be a string literal, it is read after the call returned.
+	// Use the MIRAGE_LOG macros, which skip the call and the evaluation of the arguments below the level.
+	template <typename... TArgs>
+	static void Write(LogType type, const char* format, const TArgs&... args) {
+		static_assert(sizeof...(TArgs) <= LOGGER_MAX_ARGUMENTS, "too many log arguments");
+		const LogArgument arguments[sizeof...(TArgs) + 1] = { MakeLogArgument(args)... };
+		WriteArguments(type, format, arguments, static_cast<int>(sizeof...(TArgs)));
+	}
+
+	static void WriteArguments(LogType type, const char* format, const LogArgument* arguments, int numArguments);
+
+	// The last LOGGER_HISTORY_SIZE written messages, oldest first
+	static std::vector<LogEntry> GetHistory();
+	// Messages dropped because the queue was full
+	static uint64_t GetNumDropped();
+
+private:
+	static std::atomic<int> level;
 };
 
+// Leveled logging, like MIRAGE_LOG_INFO("Loaded {} textures in {} ms", count, millisecs). The level check
+// comes first, so below MIRAGE_LOG_LEVEL or the runtime level the arguments are never evaluated.
+#define MIRAGE_LOG(type, ...) \
+	do { \
+		if ((type) >= MIRAGE_LOG_LEVEL && Logger::IsEnabled(type)) { \
+			Logger::Write((type), __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define MIRAGE_LOG_DEBUG(...) MIRAGE_LOG(LOG_DEBUG, __VA_ARGS__)
+#define MIRAGE_LOG_INFO(...) MIRAGE_LOG(LOG_INFO, __VA_ARGS__)
+#define MIRAGE_LOG_WARNING(...) MIRAGE_LOG(LOG_WARNING, __VA_ARGS__)
+#define MIRAGE_LOG_ERROR(...) MIRAGE_LOG(LOG_ERROR, __VA_ARGS__)
@@ -1,13 +1,216 @@
 #include <iostream>
+#include <string>
 #include "./Game/Game.h"
+#include "./AssetArchive/AssetArchive.h"
+
+void PrintUsage() {
+    std::cout << "Usage: MirageEngine [options]" << std::endl;
+    std::cout << "  --headless                  Run without a window using the dummy video driver and an offscreen software renderer" << std::endl;
+    std::cout << "  --no-render                 Run the simulation only, nothing is rendered" << std::endl;
+    std::cout << "  --renderer <name>           Render backend, sdl (default) or software" << std::endl;
+    std::cout << "  --no-vsync                  Disable vsync on the window renderer" << std::endl;
+    std::cout << "  --no-pipeline               Simulate and render one after the other on the main thread" << std::endl;
+    std::cout << "  --fps <n>                   Target frame rate, 0 runs uncapped" << std::endl;
+    std::cout << "  --tick-rate <n>             Simulation ticks per second, rendering interpolates between ticks" << std::endl;
+    std::cout << "  --max-ticks <n>             Most simulation ticks run per frame before time is dropped" << std::endl;
+    std::cout << "  --fixed-step                Simulate exactly one tick per frame, runs draw the same frames every time" << std::endl;
+    std::cout << "  --frames <n>                Quit after n frames" << std::endl;
+    std::cout << "  --sprites <n>               Spawn n extra moving sprites for benchmarking" << std::endl;
+    std::cout << "  --screenshot <file>         Save the last frame of a --frames run as BMP" << std::endl;
+    std::cout << "  --golden <file>             Compare the last frame of a --frames run against a BMP, exits with 1 on mismatch" << std::endl;
+    std::cout << "  --golden-threshold <f>      Fraction of pixels allowed to differ from the golden image, 0.001 by default" << std::endl;
+    std::cout << "  --trace-frames <n>          Write a Chrome trace of the profiler zones after n frames, F9 writes one at any time" << std::endl;
+    std::cout << "  --overlay                   Show the performance overlay from the start, F1 toggles it" << std::endl;
+    std::cout << "  --archive <file>            Load assets from a packed archive, missing assets fall back to loose files" << std::endl;
+    std::cout << "  --texture-cache <directory> Directory of the decoded texture cache, ./cache/textures by default" << std::endl;
+    std::cout << "  --no-texture-cache          Always decode textures from their source files" << std::endl;
+    std::cout << "  --script-cache <directory>  Directory of the compiled script cache, ./cache/scripts by default" << std::endl;
+    std::cout << "  --no-script-cache           Always compile scripts from their source files" << std::endl;
+    std::cout << "  --texture-budget <mb>       Evict unreferenced textures once they use more memory than this" << std::endl;
+    std::cout << "  --hot-reload                Reload assets whose files change while running, Linux only" << std::endl;
+    std::cout << "  --no-scripts                Do not run the Lua behaviours of scripted entities" << std::endl;
+    std::cout << "  --lua-sample-interval <n>   VM instructions between Lua profiler samples, 0 disables the profiler" << std::endl;
+    std::cout << "  --pack <file> <directory>   Pack every file below a relative directory into an archive and exit, scripts are stored compiled" << std::endl;
+    std::cout << "  --trace <file>              File the trace is written to, trace.json by default" << std::endl;
+    std::cout << "  --log-block                 Wait for the log writer when its queue is full instead of dropping messages" << std::endl;
+    std::cout << "  --log-level <level>         Lowest level logged: debug, info, warning or error" << std::endl;
+}
+
+// Set by --pack, the engine packs the directory and exits instead of running
+struct PackOptions {
+    std::string archivePath;
+    std::string directory;
+};
+
+// Returns false if the command line could not be parsed
+bool ParseArguments(int argc, char* args[], GameConfig& config, PackOptions& packOptions) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = args[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--headless") {
+            config.headless = true;
+        }
+        else if (argument == "--no-render") {
+            config.renderingEnabled = false;
+        }
+        else if (argument == "--renderer" && hasValue) {
+            std::string backend = args[++i];
+            if (backend == "software") {
+                config.renderBackend = RENDER_BACKEND_SOFTWARE;
+            }
+            else if (backend == "sdl") {
+                config.renderBackend = RENDER_BACKEND_SDL;
+            }
+            else {
+                std::cerr << "Unknown renderer: " << backend << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--no-vsync") {
+            config.vsync = false;
+        }
+        else if (argument == "--no-pipeline") {
+            config.pipelinedRendering = false;
+        }
+        else if (argument == "--fps" && hasValue) {
+            config.targetFps = std::stoi(args[++i]);
+        }
+        else if (argument == "--tick-rate" && hasValue) {
+            config.tickRate = std::stoi(args[++i]);
+        }
+        else if (argument == "--max-ticks" && hasValue) {
+            config.maxTicksPerFrame = std::stoi(args[++i]);
+        }
+        else if (argument == "--fixed-step") {
+            config.fixedStep = true;
+        }
+        else if (argument == "--frames" && hasValue) {
+            config.maxFrames = std::stoi(args[++i]);
+        }
+        else if (argument == "--sprites" && hasValue) {
+            config.stressSprites = std::stoi(args[++i]);
+        }
+        else if (argument == "--screenshot" && hasValue) {
+            config.screenshotPath = args[++i];
+        }
+        else if (argument == "--golden" && hasValue) {
+            config.goldenImagePath = args[++i];
+        }
+        else if (argument == "--golden-threshold" && hasValue) {
+            config.goldenImageThreshold = std::stod(args[++i]);
+        }
+        else if (argument == "--trace-frames" && hasValue) {
+            config.traceFrames = std::stoi(args[++i]);
+        }
+        else if (argument == "--archive" && hasValue) {
+            config.archivePath = args[++i];
+        }
+        else if (argument == "--texture-cache" && hasValue) {
+            config.textureCacheDirectory = args[++i];
+        }
+        else if (argument == "--no-texture-cache") {
+            config.textureCacheDirectory.clear();
+        }
+        else if (argument == "--script-cache" && hasValue) {
+            config.scriptCacheDirectory = args[++i];
+        }
+        else if (argument == "--no-script-cache") {
+            config.scriptCacheDirectory.clear();
+        }
+        else if (argument == "--texture-budget" && hasValue) {
+            config.textureBudgetBytes = static_cast<size_t>(std::stod(args[++i]) * 1024 * 1024);
+        }
+        else if (argument == "--pack" && i + 2 < argc) {
+            packOptions.archivePath = args[++i];
+            packOptions.directory = args[++i];
+        }
+        else if (argument == "--no-scripts") {
+            config.scriptingEnabled = false;
+        }
+        else if (argument == "--lua-sample-interval" && hasValue) {
+            config.luaSampleInstructions = std::stoi(args[++i]);
+        }
+        else if (argument == "--hot-reload") {
+            config.hotReload = true;
+        }
+        else if (argument == "--overlay") {
+            config.showOverlay = true;
+        }
+        else if (argument == "--trace" && hasValue) {
+            config.tracePath = args[++i];
+        }
+        else if (argument == "--log-block") {
+            config.logOverflowPolicy = LOG_OVERFLOW_BLOCK;
+        }
+        else if (argument == "--log-level" && hasValue) {
+            const std::string level = args[++i];
+            if (level == "debug") {
+                config.logLevel = LOG_DEBUG;
+            }
+            else if (level == "info") {
+                config.logLevel = LOG_INFO;
+            }
+            else if (level == "warning") {
+                config.logLevel = LOG_WARNING;
+            }
+            else if (level == "error") {
+                config.logLevel = LOG_ERROR;
+            }
+            else {
+                std::cerr << "Unknown log level: " << level << std::endl;
+                return false;
+            }
+        }
+        else {
+            std::cerr << "Unknown or incomplete option: " << argument << std::endl;
+            return false;
+        }
+    }
+
+    if (config.tickRate <= 0 || config.maxTicksPerFrame <= 0) {
+        std::cerr << "The tick rate and the ticks per frame have to be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
 
 int main(int argc, char* args[]) {
 
-    Game game;
+    GameConfig config;
+    PackOptions packOptions;
+    bool validArguments;
+    try {
+        validArguments = ParseArguments(argc, args, config, packOptions);
+    }
+    catch (const std::exception&) {
+        // std::stoi throws on values that are not numbers
+        validArguments = false;
+    }
+    if (!validArguments) {
+        PrintUsage();
+        return 1;
+    }
+
+    // Log calls only queue their message from here on, a background thread writes them
+    Logger::SetLevel(config.logLevel);
+    Logger::Start(config.logOverflowPolicy);
+
+    int exitCode;
+    if (!packOptions.archivePath.empty()) {
+        exitCode = AssetArchive::Pack(packOptions.archivePath, packOptions.directory, &ScriptEngine::CompileForArchive) ? 0 : 1;
+    }
+    else {
+        // Scoped so the destructor logs before the logger stops
+        Game game(config);
+
+        game.Initialize();
+        game.Run();
+        game.Destroy();
 
-    game.Initialize();
-    game.Run();
-    game.Destroy();
+        exitCode = game.GetExitCode();
+    }
 
-    return 0;
+    Logger::Stop();
+    return exitCode;
 }
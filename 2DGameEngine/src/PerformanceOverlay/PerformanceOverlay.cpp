@@ -0,0 +1,122 @@
+#include "PerformanceOverlay.h"
+#include "../EngineCounters/EngineCounters.h"
+#include <imgui/imgui.h>
+#include <imgui/imgui_sdl.h>
+#include <algorithm>
+
+const float BYTES_PER_KILOBYTE = 1024.0f;
+const float BYTES_PER_MEGABYTE = 1024.0f * 1024.0f;
+
+PerformanceOverlay::PerformanceOverlay(SDL_Renderer* renderer, int windowWidth, int windowHeight) {
+	ImGui::CreateContext();
+	ImGui::StyleColorsDark();
+	// The overlay is recreated every run, there are no window positions worth saving
+	ImGui::GetIO().IniFilename = nullptr;
+	ImGuiSDL::Initialize(renderer, windowWidth, windowHeight);
+	previousFrameCounter = SDL_GetPerformanceCounter();
+}
+
+PerformanceOverlay::~PerformanceOverlay() {
+	ImGuiSDL::Deinitialize();
+	ImGui::DestroyContext();
+}
+
+void PerformanceOverlay::Toggle() {
+	isVisible = !isVisible;
+	// Keep the first overlay frame from seeing the whole hidden time as its delta
+	previousFrameCounter = SDL_GetPerformanceCounter();
+}
+
+bool PerformanceOverlay::IsVisible() const {
+	return isVisible;
+}
+
+void PerformanceOverlay::ProcessEvent(const SDL_Event& event) {
+	if (event.type == SDL_MOUSEWHEEL) {
+		ImGuiIO& io = ImGui::GetIO();
+		io.MouseWheel += static_cast<float>(event.wheel.y);
+		io.MouseWheelH += static_cast<float>(event.wheel.x);
+	}
+}
+
+void PerformanceOverlay::Render(const OverlayStats& stats, const FramePacer& framePacer) {
+	ImGuiIO& io = ImGui::GetIO();
+
+	Uint64 frameCounter = SDL_GetPerformanceCounter();
+	io.DeltaTime = std::max(static_cast<float>(frameCounter - previousFrameCounter) / SDL_GetPerformanceFrequency(), 0.0001f);
+	previousFrameCounter = frameCounter;
+
+	int mouseX, mouseY;
+	const Uint32 buttons = SDL_GetMouseState(&mouseX, &mouseY);
+	io.MousePos = ImVec2(static_cast<float>(mouseX), static_cast<float>(mouseY));
+	io.MouseDown[0] = (buttons & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
+	io.MouseDown[1] = (buttons & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
+
+	ImGui::NewFrame();
+
+	ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowBgAlpha(0.8f);
+	if (ImGui::Begin("Performance (F1)")) {
+		const FrameTimeStats frameTimeStats = framePacer.GetStats();
+		ImGui::Text("Frame time p50 %.2f ms  p95 %.2f ms  p99 %.2f ms", frameTimeStats.p50Millisecs, frameTimeStats.p95Millisecs, frameTimeStats.p99Millisecs);
+
+		const float* frameTimes;
+		int frameTimeCount;
+		int frameTimeOffset;
+		framePacer.GetFrameTimes(frameTimes, frameTimeCount, frameTimeOffset);
+		// Fixed scale so spikes stand out instead of squashing the rest of the graph
+		const float graphMax = static_cast<float>(std::max(frameTimeStats.p99Millisecs * 1.5, 1.0));
+		ImGui::PlotLines("##FrameTimes", frameTimes, frameTimeCount, frameTimeOffset, nullptr, 0.0f, graphMax, ImVec2(0.0f, 80.0f));
+
+		if (ImGui::CollapsingHeader("Systems", ImGuiTreeNodeFlags_DefaultOpen)) {
+			for (int counter = COUNTER_SIMULATION_TICKS; counter <= COUNTER_RENDER_MICROSECS; counter++) {
+				const EngineCounter engineCounter = static_cast<EngineCounter>(counter);
+				const char* unit = engineCounter == COUNTER_SIMULATION_TICKS ? "" : " us";
+				ImGui::Text("%-34s %8lld%s", EngineCounters::GetName(engineCounter), static_cast<long long>(EngineCounters::Get(engineCounter)), unit);
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Renderer", ImGuiTreeNodeFlags_DefaultOpen)) {
+			for (int counter = COUNTER_SPRITES_DRAWN; counter <= COUNTER_TEXTURE_SWITCHES; counter++) {
+				const EngineCounter engineCounter = static_cast<EngineCounter>(counter);
+				ImGui::Text("%-34s %8lld", EngineCounters::GetName(engineCounter), static_cast<long long>(EngineCounters::Get(engineCounter)));
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Scripting", ImGuiTreeNodeFlags_DefaultOpen)) {
+			for (int counter = COUNTER_SCRIPT_CALLS; counter < NUM_ENGINE_COUNTERS; counter++) {
+				const EngineCounter engineCounter = static_cast<EngineCounter>(counter);
+				ImGui::Text("%-34s %8lld", EngineCounters::GetName(engineCounter), static_cast<long long>(EngineCounters::Get(engineCounter)));
+			}
+		}
+
+		if (stats.luaSampleCount > 0 && ImGui::CollapsingHeader("Lua hotspots", ImGuiTreeNodeFlags_DefaultOpen)) {
+			ImGui::Text("%llu samples", static_cast<unsigned long long>(stats.luaSampleCount));
+			for (int index = 0; index < stats.luaHotspotCount; index++) {
+				const LuaHotspot& hotspot = stats.luaHotspots[index];
+				ImGui::Text("%6.2f%%  %-24s %s", 100.0 * hotspot.hits / stats.luaSampleCount, hotspot.function, hotspot.location);
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Entities", ImGuiTreeNodeFlags_DefaultOpen)) {
+			ImGui::Text("Entities %d", stats.entityCount);
+			size_t totalPoolMemory = 0;
+			for (int componentId = 0; componentId < stats.componentPoolCount; componentId++) {
+				totalPoolMemory += stats.componentPoolMemory[componentId];
+				ImGui::Text("Component %2d pool %8d slots %10.1f KB", componentId, stats.componentPoolSizes[componentId], stats.componentPoolMemory[componentId] / BYTES_PER_KILOBYTE);
+			}
+			ImGui::Text("Component pools %.2f MB", totalPoolMemory / BYTES_PER_MEGABYTE);
+		}
+
+		if (ImGui::CollapsingHeader("Assets", ImGuiTreeNodeFlags_DefaultOpen)) {
+			ImGui::Text("Textures %d, %.2f MB", stats.textureCount, stats.textureMemory / BYTES_PER_MEGABYTE);
+			if (stats.textureBudget > 0) {
+				ImGui::Text("Texture budget %.2f MB", stats.textureBudget / BYTES_PER_MEGABYTE);
+			}
+		}
+	}
+	ImGui::End();
+
+	ImGui::Render();
+	ImGuiSDL::Render(ImGui::GetDrawData());
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL.h>
+#include "../ECS/ECS.h"
+#include "../FramePacer/FramePacer.h"
+#include "../Scripting/LuaProfiler.h"
+
+// Rows of the Lua hotspot table
+const int OVERLAY_LUA_HOTSPOTS = 10;
+
+// Registry and asset statistics, copied by the game while the simulation thread is idle
+struct OverlayStats {
+	int entityCount;
+	int componentPoolCount;
+	int componentPoolSizes[MAX_COMPONENTS];
+	size_t componentPoolMemory[MAX_COMPONENTS];
+	int textureCount;
+	size_t textureMemory;
+	// 0 if textures are never evicted
+	size_t textureBudget;
+	// Lines of the Lua scripts with the most profiler samples
+	LuaHotspot luaHotspots[OVERLAY_LUA_HOTSPOTS];
+	int luaHotspotCount;
+	uint64_t luaSampleCount;
+};
+
+// ImGui window showing frame times, engine counters and memory usage, drawn with the SDL renderer.
+// Only one overlay can exist at a time because it owns the ImGui context.
+class PerformanceOverlay
+{
+private:
+	bool isVisible = false;
+	Uint64 previousFrameCounter;
+
+public:
+	PerformanceOverlay(SDL_Renderer* renderer, int windowWidth, int windowHeight);
+	~PerformanceOverlay();
+
+	void Toggle();
+	bool IsVisible() const;
+
+	// Forwards input ImGui can not poll, like the mouse wheel
+	void ProcessEvent(const SDL_Event& event);
+
+	// Draws the overlay on top of the current frame, everything is formatted in place so nothing is allocated
+	void Render(const OverlayStats& stats, const FramePacer& framePacer);
+};
@@ -0,0 +1,187 @@
+#include "Profiler.h"
+#include "../Logger/Logger.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_set>
+#include <fstream>
+#include <cstdio>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+
+	// The owning thread overwrites old slots while a trace is written, the fields are atomics so the trace
+	// writer can copy them and check afterwards whether they were overwritten. Relaxed atomics compile to
+	// plain loads and stores.
+	struct EventSlot {
+		std::atomic<const char*> name;
+		std::atomic<uint64_t> start;
+		std::atomic<uint64_t> end;
+	};
+
+	struct ThreadBuffer {
+		EventSlot events[Profiler::EVENTS_PER_THREAD];
+		// Total number of events ever written, the ring position is writeIndex % EVENTS_PER_THREAD
+		std::atomic<uint64_t> writeIndex;
+		int threadId;
+		std::string threadName;
+	};
+
+	std::mutex buffersMutex;
+	// Buffers stay alive after their thread exits so its zones can still be written out
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	thread_local ThreadBuffer* threadBuffer = nullptr;
+
+	std::mutex namesMutex;
+	// Node based, the strings never move
+	std::unordered_set<std::string> internedNames;
+
+	// Taken at startup and compared with the time a trace is written to find the tick rate
+	const uint64_t calibrationTicks = Profiler::Now();
+	const std::chrono::steady_clock::time_point calibrationTime = std::chrono::steady_clock::now();
+
+	double GetTicksPerMicrosec() {
+#if PROFILER_USE_TSC
+		const uint64_t ticks = Profiler::Now() - calibrationTicks;
+		const double microsecs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - calibrationTime).count();
+		return microsecs > 0.0 ? ticks / microsecs : 1000.0;
+#else
+		return 1000.0;
+#endif
+	}
+
+	ThreadBuffer* GetThreadBuffer() {
+		if (!threadBuffer) {
+			std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+			buffer->writeIndex = 0;
+
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			buffer->threadId = static_cast<int>(buffers.size()) + 1;
+			buffer->threadName = "Thread " + std::to_string(buffer->threadId);
+			threadBuffer = buffer.get();
+			buffers.push_back(std::move(buffer));
+		}
+		return threadBuffer;
+	}
+
+	void WriteJsonString(std::ofstream& file, const std::string& text) {
+		file << '"';
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				file << '\\' << c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20) {
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				file << escaped;
+			}
+			else {
+				file << c;
+			}
+		}
+		file << '"';
+	}
+}
+
+void Profiler::RecordZone(const char* name, uint64_t start, uint64_t end) {
+	ThreadBuffer* buffer = GetThreadBuffer();
+	const uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+
+	// A trace writer seeing any of the stores below also sees the previous event published, which tells it
+	// the slot is being reused
+	std::atomic_thread_fence(std::memory_order_release);
+	EventSlot& event = buffer->events[index % EVENTS_PER_THREAD];
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.end.store(end, std::memory_order_relaxed);
+
+	// Publish the event to readers
+	buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+const char* Profiler::InternName(const std::string& name) {
+	std::lock_guard<std::mutex> lock(namesMutex);
+	return internedNames.insert(name).first->c_str();
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	ThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	buffer->threadName = name;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filePath) {
+	std::ofstream file(filePath);
+	if (!file) {
+		MIRAGE_LOG_ERROR("Error opening trace file {}", filePath);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	const double ticksPerMicrosec = GetTicksPerMicrosec();
+
+	// Timestamps relative to the earliest buffered zone keep the numbers short
+	uint64_t origin = UINT64_MAX;
+	for (const auto& buffer : buffers) {
+		const uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+		const uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+		if (end > begin) {
+			origin = std::min(origin, buffer->events[begin % EVENTS_PER_THREAD].start.load(std::memory_order_relaxed));
+		}
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool isFirst = true;
+	int eventCount = 0;
+
+	for (const auto& buffer : buffers) {
+		file << (isFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+		WriteJsonString(file, buffer->threadName);
+		file << "}}";
+		isFirst = false;
+
+		// The owning thread keeps writing while this runs, so copy out the published window first
+		// and then drop whatever may have been overwritten in the meantime
+		const uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+		const uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+		std::vector<ProfileEvent> events;
+		events.reserve(static_cast<size_t>(end - begin));
+		for (uint64_t index = begin; index < end; index++) {
+			const EventSlot& slot = buffer->events[index % EVENTS_PER_THREAD];
+			events.push_back({
+				slot.name.load(std::memory_order_relaxed),
+				slot.start.load(std::memory_order_relaxed),
+				slot.end.load(std::memory_order_relaxed)
+			});
+		}
+		// Pairs with the fence in RecordZone, if the copy saw a store of a later event the index read below
+		// includes the event before it. The slot of the event being recorded right now counts as overwritten.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t endAfterCopy = buffer->writeIndex.load(std::memory_order_relaxed);
+		const uint64_t firstValid = endAfterCopy >= EVENTS_PER_THREAD ? endAfterCopy - EVENTS_PER_THREAD + 1 : 0;
+
+		for (uint64_t index = begin; index < end; index++) {
+			if (index < firstValid) {
+				continue;
+			}
+			const ProfileEvent& event = events[static_cast<size_t>(index - begin)];
+			if (event.start < origin) {
+				continue;
+			}
+			file << ",\n{\"name\":";
+			WriteJsonString(file, event.name);
+			file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << (event.start - origin) / ticksPerMicrosec
+				<< ",\"dur\":" << (event.end - event.start) / ticksPerMicrosec << "}";
+			eventCount++;
+		}
+	}
+
+	file << "\n]}\n";
+	MIRAGE_LOG_INFO("Wrote {} profiler zones to {}", eventCount, filePath);
+	return true;
+}
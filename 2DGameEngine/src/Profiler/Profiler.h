@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_USE_TSC 1
+#else
+#define PROFILER_USE_TSC 0
+#endif
+
+// Define MIRAGE_PROFILER as 0 in the preprocessor definitions to compile all zones out
+#ifndef MIRAGE_PROFILER
+#define MIRAGE_PROFILER 1
+#endif
+
+// A timed zone, times are in Profiler::Now ticks
+struct ProfileEvent {
+	// Must outlive the profiler, string literals or interned names
+	const char* name;
+	uint64_t start;
+	uint64_t end;
+};
+
+// Collects zones into one ring buffer per thread. Only the owning thread writes to its buffer,
+// so recording a zone takes no locks. Old zones are overwritten once a buffer is full.
+class Profiler
+{
+public:
+	static const int EVENTS_PER_THREAD = 1 << 16;
+
+	// Time stamp counter on x86, reading it is several times cheaper than the steady clock.
+	// Ticks are converted to microseconds only when a trace is written.
+	static uint64_t Now() {
+#if PROFILER_USE_TSC
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	static void RecordZone(const char* name, uint64_t start, uint64_t end);
+
+	// Copies a name built at runtime so zones can use it, the copy is never freed. Thread safe.
+	static const char* InternName(const std::string& name);
+
+	// Names the calling thread in the trace
+	static void SetThreadName(const std::string& name);
+
+	// Writes the buffered zones of all threads as a Chrome about:tracing / Perfetto JSON file
+	static bool WriteChromeTrace(const std::string& filePath);
+};
+
+class ProfileScope
+{
+private:
+	const char* name;
+	uint64_t start;
+
+public:
+	ProfileScope(const char* name): name(name), start(Profiler::Now()) {}
+
+	~ProfileScope() {
+		Profiler::RecordZone(name, start, Profiler::Now());
+	}
+};
+
+#if MIRAGE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
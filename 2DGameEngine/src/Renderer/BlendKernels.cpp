@@ -0,0 +1,176 @@
+#include "BlendKernels.h"
+#include <SDL.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define BLEND_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(BLEND_KERNELS_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BLEND_KERNELS_SSE2
+#endif
+
+// MSVC compiles AVX2 intrinsics without /arch:AVX2, other compilers need the function to opt in.
+// The kernel is only called when the CPU reports AVX2 support.
+#if defined(BLEND_KERNELS_X86)
+#define BLEND_KERNELS_AVX2
+#if defined(_MSC_VER)
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// RGBA32 keeps red in the first byte in memory, so alpha is the top byte on little endian machines
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+const int ALPHA_SHIFT = 0;
+#else
+const int ALPHA_SHIFT = 24;
+#endif
+
+// out = (src * alpha + dst * (255 - alpha)) / 255 per channel, rounded. The alpha channel itself
+// blends as if its source value was 255, which gives outAlpha = alpha + dstAlpha * (1 - alpha).
+static inline uint32_t BlendPixel(uint32_t dst, uint32_t src) {
+	const uint32_t alpha = (src >> ALPHA_SHIFT) & 0xFF;
+	if (alpha == 255) {
+		return src;
+	}
+	if (alpha == 0) {
+		return dst;
+	}
+
+	const uint32_t inverseAlpha = 255 - alpha;
+	uint32_t result = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		const uint32_t source = shift == ALPHA_SHIFT ? 255 : (src >> shift) & 0xFF;
+		const uint32_t destination = (dst >> shift) & 0xFF;
+		const uint32_t t = source * alpha + destination * inverseAlpha + 128;
+		result |= ((t + (t >> 8)) >> 8) << shift;
+	}
+	return result;
+}
+
+void BlendRowScalar(uint32_t* dst, const uint32_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = BlendPixel(dst[i], src[i]);
+	}
+}
+
+#ifdef BLEND_KERNELS_SSE2
+// Blends 16-bit widened channels, the same arithmetic as BlendPixel
+static inline __m128i BlendChannelsSSE2(__m128i source, __m128i destination, __m128i alpha) {
+	const __m128i inverseAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(source, alpha), _mm_mullo_epi16(destination, inverseAlpha));
+	t = _mm_add_epi16(t, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static void BlendRowSSE2(uint32_t* dst, const uint32_t* src, int count) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(255);
+	const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i alpha = _mm_srli_epi32(source, 24);
+
+		// Fully transparent and fully opaque runs are common in sprites
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) {
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) == 0xFFFF) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), source);
+			continue;
+		}
+
+		__m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+		// Broadcast each pixel's alpha to its four 16-bit channels
+		alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+		__m128i alphaLow = _mm_unpacklo_epi32(alpha, alpha);
+		__m128i alphaHigh = _mm_unpackhi_epi32(alpha, alpha);
+
+		source = _mm_or_si128(source, alphaMask);
+		__m128i low = BlendChannelsSSE2(_mm_unpacklo_epi8(source, zero), _mm_unpacklo_epi8(destination, zero), alphaLow);
+		__m128i high = BlendChannelsSSE2(_mm_unpackhi_epi8(source, zero), _mm_unpackhi_epi8(destination, zero), alphaHigh);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+	}
+
+	BlendRowScalar(dst + i, src + i, count - i);
+}
+#endif
+
+#ifdef BLEND_KERNELS_AVX2
+TARGET_AVX2 static inline __m256i BlendChannelsAVX2(__m256i source, __m256i destination, __m256i alpha) {
+	const __m256i inverseAlpha = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+	__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(source, alpha), _mm256_mullo_epi16(destination, inverseAlpha));
+	t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// Same as the SSE2 kernel on 8 pixels, unpack and pack work per 128-bit lane so the pixel order is kept
+TARGET_AVX2 static void BlendRowAVX2(uint32_t* dst, const uint32_t* src, int count) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(255);
+	const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		__m256i alpha = _mm256_srli_epi32(source, 24);
+
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, zero)) == -1) {
+			continue;
+		}
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, opaque)) == -1) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), source);
+			continue;
+		}
+
+		__m256i destination = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+		alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+		__m256i alphaLow = _mm256_unpacklo_epi32(alpha, alpha);
+		__m256i alphaHigh = _mm256_unpackhi_epi32(alpha, alpha);
+
+		source = _mm256_or_si256(source, alphaMask);
+		__m256i low = BlendChannelsAVX2(_mm256_unpacklo_epi8(source, zero), _mm256_unpacklo_epi8(destination, zero), alphaLow);
+		__m256i high = BlendChannelsAVX2(_mm256_unpackhi_epi8(source, zero), _mm256_unpackhi_epi8(destination, zero), alphaHigh);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+	}
+
+	BlendRowScalar(dst + i, src + i, count - i);
+}
+#endif
+
+BlendRowFunction GetBlendRowFunction() {
+#ifdef BLEND_KERNELS_AVX2
+	if (SDL_HasAVX2()) {
+		return BlendRowAVX2;
+	}
+#endif
+#ifdef BLEND_KERNELS_SSE2
+	if (SDL_HasSSE2()) {
+		return BlendRowSSE2;
+	}
+#endif
+	return BlendRowScalar;
+}
+
+const char* GetBlendRowFunctionName() {
+	BlendRowFunction blendRow = GetBlendRowFunction();
+#ifdef BLEND_KERNELS_AVX2
+	if (blendRow == BlendRowAVX2) {
+		return "AVX2";
+	}
+#endif
+#ifdef BLEND_KERNELS_SSE2
+	if (blendRow == BlendRowSSE2) {
+		return "SSE2";
+	}
+#endif
+	return "scalar";
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Blends count RGBA32 source pixels over the destination pixels with straight alpha,
+// the same result as SDL_BLENDMODE_BLEND
+typedef void (*BlendRowFunction)(uint32_t* dst, const uint32_t* src, int count);
+
+void BlendRowScalar(uint32_t* dst, const uint32_t* src, int count);
+
+// Picks the widest kernel the CPU supports, AVX2, SSE2 or scalar
+BlendRowFunction GetBlendRowFunction();
+const char* GetBlendRowFunctionName();
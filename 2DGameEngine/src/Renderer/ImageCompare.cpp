@@ -0,0 +1,43 @@
+#include "ImageCompare.h"
+#include <cstdlib>
+#include <algorithm>
+
+bool CompareImages(SDL_Surface* image, SDL_Surface* reference, int tolerance, ImageDifference& difference) {
+	difference.mismatchedPixels = 0;
+	difference.totalPixels = 0;
+	difference.maxChannelDifference = 0;
+
+	if (image->w != reference->w || image->h != reference->h) {
+		return false;
+	}
+
+	// Compare both in the same byte order
+	SDL_Surface* imagePixels = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_Surface* referencePixels = SDL_ConvertSurfaceFormat(reference, SDL_PIXELFORMAT_RGBA32, 0);
+	if (!imagePixels || !referencePixels) {
+		SDL_FreeSurface(imagePixels);
+		SDL_FreeSurface(referencePixels);
+		return false;
+	}
+
+	difference.totalPixels = image->w * image->h;
+	for (int y = 0; y < image->h; y++) {
+		const Uint8* imageRow = static_cast<const Uint8*>(imagePixels->pixels) + y * imagePixels->pitch;
+		const Uint8* referenceRow = static_cast<const Uint8*>(referencePixels->pixels) + y * referencePixels->pitch;
+
+		for (int x = 0; x < image->w; x++) {
+			int pixelDifference = 0;
+			for (int channel = 0; channel < 4; channel++) {
+				pixelDifference = std::max(pixelDifference, std::abs(imageRow[x * 4 + channel] - referenceRow[x * 4 + channel]));
+			}
+			difference.maxChannelDifference = std::max(difference.maxChannelDifference, pixelDifference);
+			if (pixelDifference > tolerance) {
+				difference.mismatchedPixels++;
+			}
+		}
+	}
+
+	SDL_FreeSurface(imagePixels);
+	SDL_FreeSurface(referencePixels);
+	return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <SDL.h>
+
+struct ImageDifference {
+	int mismatchedPixels;
+	int totalPixels;
+	int maxChannelDifference;
+};
+
+// Compares two images pixel by pixel, a pixel mismatches when any channel differs by more than tolerance.
+// Returns false if the images can not be compared because their sizes differ.
+bool CompareImages(SDL_Surface* image, SDL_Surface* reference, int tolerance, ImageDifference& difference);
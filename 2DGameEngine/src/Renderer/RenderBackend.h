@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <SDL.h>
+#include "../AssetStore/AssetHandle.h"
+
+// One textured sprite to draw, rotated clockwise in degrees around the center of dstRect like SDL_RenderCopyEx
+struct SpriteDrawCommand {
+	TextureHandle texture;
+	SDL_Rect srcRect;
+	SDL_Rect dstRect;
+	double rotation;
+};
+
+// Everything the render thread needs to draw one simulated frame.
+// Filled by the RenderSystem at the end of Update and not modified while it is being rendered.
+struct RenderFrame {
+	std::vector<SpriteDrawCommand> sprites;
+};
+
+// Interface the render thread submits sprite batches to
+class IRenderBackend {
+public:
+	virtual ~IRenderBackend() {}
+
+	virtual void BeginFrame(const SDL_Color& clearColor) = 0;
+	// Sprites are drawn in submission order
+	virtual void DrawSprites(const std::vector<SpriteDrawCommand>& sprites) = 0;
+	// Finishes all drawing of the frame, the frame can be read back until Present
+	virtual void EndFrame() = 0;
+	virtual void Present() = 0;
+
+	// Returns a copy of the current frame as an RGBA32 surface the caller has to free
+	virtual SDL_Surface* ReadPixels() = 0;
+};
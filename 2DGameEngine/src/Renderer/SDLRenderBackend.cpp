@@ -0,0 +1,67 @@
+#include "SDLRenderBackend.h"
+#include "../EngineCounters/EngineCounters.h"
+
+SDLRenderBackend::SDLRenderBackend(SDL_Renderer* renderer, const AssetStore& assetStore): renderer(renderer), assetStore(assetStore) {
+}
+
+void SDLRenderBackend::BeginFrame(const SDL_Color& clearColor) {
+	SDL_SetRenderDrawColor(renderer, clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+	SDL_RenderClear(renderer);
+}
+
+void SDLRenderBackend::DrawSprites(const std::vector<SpriteDrawCommand>& sprites) {
+	int drawCalls = 0;
+	int textureSwitches = 0;
+	SDL_Texture* previousTexture = nullptr;
+
+	for (const auto& sprite : sprites) {
+		SDL_Texture* texture = assetStore.GetTexture(sprite.texture);
+		if (!texture) {
+			continue;
+		}
+
+		if (texture != previousTexture) {
+			textureSwitches++;
+			previousTexture = texture;
+		}
+		drawCalls++;
+
+		SDL_RenderCopyEx(
+			renderer,
+			texture,
+			&sprite.srcRect,
+			&sprite.dstRect,
+			sprite.rotation,
+			NULL,
+			SDL_FLIP_NONE
+		);
+	}
+
+	EngineCounters::Set(COUNTER_SPRITES_DRAWN, drawCalls);
+	EngineCounters::Set(COUNTER_DRAW_CALLS, drawCalls);
+	EngineCounters::Set(COUNTER_TEXTURE_SWITCHES, textureSwitches);
+}
+
+void SDLRenderBackend::EndFrame() {
+}
+
+void SDLRenderBackend::Present() {
+	SDL_RenderPresent(renderer);
+}
+
+SDL_Surface* SDLRenderBackend::ReadPixels() {
+	int width;
+	int height;
+	SDL_GetRendererOutputSize(renderer, &width, &height);
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+	if (!surface) {
+		return nullptr;
+	}
+
+	if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGBA32, surface->pixels, surface->pitch) != 0) {
+		SDL_FreeSurface(surface);
+		return nullptr;
+	}
+	return surface;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include "../AssetStore/AssetStore.h"
+
+// Draws sprites through an SDL_Renderer
+class SDLRenderBackend: public IRenderBackend
+{
+private:
+	SDL_Renderer* renderer;
+	const AssetStore& assetStore;
+
+public:
+	SDLRenderBackend(SDL_Renderer* renderer, const AssetStore& assetStore);
+
+	void BeginFrame(const SDL_Color& clearColor) override;
+	void DrawSprites(const std::vector<SpriteDrawCommand>& sprites) override;
+	void EndFrame() override;
+	void Present() override;
+	SDL_Surface* ReadPixels() override;
+};
@@ -0,0 +1,241 @@
+#include "SoftwareRenderBackend.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include "../EngineCounters/EngineCounters.h"
+#include <algorithm>
+#include <cmath>
+
+const double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0;
+
+SoftwareRenderBackend::SoftwareRenderBackend(int width, int height, SDL_Window* window, const AssetStore& assetStore, JobSystem& jobSystem):
+	width(width), height(height), window(window), assetStore(assetStore), jobSystem(jobSystem) {
+
+	framebuffer.resize(width * height);
+	framebufferSurface = SDL_CreateRGBSurfaceWithFormatFrom(framebuffer.data(), width, height, 32, width * 4, SDL_PIXELFORMAT_RGBA32);
+
+	tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	tileBins.resize(tilesX * tilesY);
+
+	rowBuffers.resize(jobSystem.GetNumThreads());
+	for (auto& rowBuffer : rowBuffers) {
+		rowBuffer.resize(TILE_SIZE);
+	}
+
+	blendRow = GetBlendRowFunction();
+	clearColor = 0;
+
+	MIRAGE_LOG_INFO("Software renderer using {} blending on {} tiles", GetBlendRowFunctionName(), tilesX * tilesY);
+}
+
+SoftwareRenderBackend::~SoftwareRenderBackend() {
+	SDL_FreeSurface(framebufferSurface);
+}
+
+void SoftwareRenderBackend::BeginFrame(const SDL_Color& clearColor) {
+	this->clearColor = SDL_MapRGBA(framebufferSurface->format, clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+
+	preparedSprites.clear();
+	for (auto& tileBin : tileBins) {
+		tileBin.clear();
+	}
+}
+
+void SoftwareRenderBackend::DrawSprites(const std::vector<SpriteDrawCommand>& sprites) {
+	const SDL_Rect screen = { 0, 0, width, height };
+	int textureSwitches = 0;
+	const uint32_t* previousPixels = nullptr;
+
+	for (const auto& command : sprites) {
+		const TextureInfo* textureInfo = assetStore.GetTextureInfo(command.texture);
+		if (!textureInfo || !textureInfo->pixels || command.dstRect.w <= 0 || command.dstRect.h <= 0) {
+			continue;
+		}
+
+		PreparedSprite sprite;
+		sprite.pixels = static_cast<const uint32_t*>(textureInfo->pixels->pixels);
+		sprite.pitch = textureInfo->pixels->pitch / 4;
+		sprite.dstRect = command.dstRect;
+
+		// Never read outside of the texture
+		const SDL_Rect textureRect = { 0, 0, textureInfo->pixels->w, textureInfo->pixels->h };
+		if (!SDL_IntersectRect(&command.srcRect, &textureRect, &sprite.srcRect)) {
+			continue;
+		}
+
+		const double angle = std::fmod(command.rotation, 360.0);
+		sprite.isRotated = angle != 0.0;
+		sprite.centerX = sprite.dstRect.x + sprite.dstRect.w * 0.5f;
+		sprite.centerY = sprite.dstRect.y + sprite.dstRect.h * 0.5f;
+
+		SDL_Rect bounds = sprite.dstRect;
+		if (sprite.isRotated) {
+			const double radians = angle * DEGREES_TO_RADIANS;
+			sprite.cosAngle = static_cast<float>(std::cos(radians));
+			sprite.sinAngle = static_cast<float>(std::sin(radians));
+
+			// Bounding box of the rotated destination rectangle
+			const float halfWidth = sprite.dstRect.w * 0.5f;
+			const float halfHeight = sprite.dstRect.h * 0.5f;
+			const float extentX = std::fabs(halfWidth * sprite.cosAngle) + std::fabs(halfHeight * sprite.sinAngle);
+			const float extentY = std::fabs(halfWidth * sprite.sinAngle) + std::fabs(halfHeight * sprite.cosAngle);
+			bounds.x = static_cast<int>(std::floor(sprite.centerX - extentX));
+			bounds.y = static_cast<int>(std::floor(sprite.centerY - extentY));
+			bounds.w = static_cast<int>(std::ceil(sprite.centerX + extentX)) - bounds.x;
+			bounds.h = static_cast<int>(std::ceil(sprite.centerY + extentY)) - bounds.y;
+		}
+		else {
+			sprite.cosAngle = 1.0f;
+			sprite.sinAngle = 0.0f;
+		}
+
+		if (!SDL_IntersectRect(&bounds, &screen, &sprite.bounds)) {
+			continue;
+		}
+
+		if (sprite.pixels != previousPixels) {
+			textureSwitches++;
+			previousPixels = sprite.pixels;
+		}
+
+		const uint32_t spriteIndex = static_cast<uint32_t>(preparedSprites.size());
+		preparedSprites.push_back(sprite);
+
+		// Bin the sprite into every tile its bounding box touches
+		const int firstTileX = sprite.bounds.x / TILE_SIZE;
+		const int lastTileX = (sprite.bounds.x + sprite.bounds.w - 1) / TILE_SIZE;
+		const int firstTileY = sprite.bounds.y / TILE_SIZE;
+		const int lastTileY = (sprite.bounds.y + sprite.bounds.h - 1) / TILE_SIZE;
+		for (int tileY = firstTileY; tileY <= lastTileY; tileY++) {
+			for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+				tileBins[tileY * tilesX + tileX].push_back(spriteIndex);
+			}
+		}
+	}
+
+	// Sprites are rasterized on the CPU, the only draw is the framebuffer upload in Present
+	EngineCounters::Set(COUNTER_SPRITES_DRAWN, static_cast<int64_t>(preparedSprites.size()));
+	EngineCounters::Set(COUNTER_DRAW_CALLS, 0);
+	EngineCounters::Set(COUNTER_TEXTURE_SWITCHES, textureSwitches);
+}
+
+void SoftwareRenderBackend::EndFrame() {
+	PROFILE_SCOPE("SoftwareRenderBackend::EndFrame");
+
+	// Every tile owns a disjoint part of the framebuffer, so tiles need no synchronization
+	jobSystem.ParallelFor(tilesX * tilesY, [this](int tileIndex, int workerIndex) {
+		RasterizeTile(tileIndex, workerIndex);
+	});
+}
+
+void SoftwareRenderBackend::RasterizeTile(int tileIndex, int workerIndex) {
+	PROFILE_SCOPE("SoftwareRenderBackend::RasterizeTile");
+
+	const int tileX = (tileIndex % tilesX) * TILE_SIZE;
+	const int tileY = (tileIndex / tilesX) * TILE_SIZE;
+	const SDL_Rect tile = {
+		tileX,
+		tileY,
+		std::min(TILE_SIZE, width - tileX),
+		std::min(TILE_SIZE, height - tileY)
+	};
+
+	for (int y = tile.y; y < tile.y + tile.h; y++) {
+		uint32_t* row = &framebuffer[y * width + tile.x];
+		std::fill(row, row + tile.w, clearColor);
+	}
+
+	uint32_t* rowBuffer = rowBuffers[workerIndex].data();
+	for (uint32_t spriteIndex : tileBins[tileIndex]) {
+		const PreparedSprite& sprite = preparedSprites[spriteIndex];
+
+		SDL_Rect region;
+		if (!SDL_IntersectRect(&sprite.bounds, &tile, &region)) {
+			continue;
+		}
+
+		if (sprite.isRotated) {
+			DrawRotated(sprite, region, rowBuffer);
+		}
+		else {
+			DrawAxisAligned(sprite, region, rowBuffer);
+		}
+	}
+}
+
+void SoftwareRenderBackend::DrawAxisAligned(const PreparedSprite& sprite, const SDL_Rect& region, uint32_t* rowBuffer) {
+	const SDL_Rect& src = sprite.srcRect;
+	const SDL_Rect& dst = sprite.dstRect;
+
+	// Nearest neighbour sampling at pixel centers in 16.16 fixed point
+	const int64_t stepX = (static_cast<int64_t>(src.w) << 16) / dst.w;
+	const int64_t stepY = (static_cast<int64_t>(src.h) << 16) / dst.h;
+	const bool isUnscaledX = src.w == dst.w;
+
+	for (int y = region.y; y < region.y + region.h; y++) {
+		const int srcY = src.y + static_cast<int>((stepY / 2 + (y - dst.y) * stepY) >> 16);
+		const uint32_t* srcRow = sprite.pixels + srcY * sprite.pitch + src.x;
+		uint32_t* dstRow = &framebuffer[y * width + region.x];
+
+		if (isUnscaledX) {
+			// Blend straight from the texture row
+			blendRow(dstRow, srcRow + (region.x - dst.x), region.w);
+			continue;
+		}
+
+		int64_t srcX = stepX / 2 + (region.x - dst.x) * stepX;
+		for (int i = 0; i < region.w; i++) {
+			rowBuffer[i] = srcRow[srcX >> 16];
+			srcX += stepX;
+		}
+		blendRow(dstRow, rowBuffer, region.w);
+	}
+}
+
+void SoftwareRenderBackend::DrawRotated(const PreparedSprite& sprite, const SDL_Rect& region, uint32_t* rowBuffer) {
+	const SDL_Rect& src = sprite.srcRect;
+	const float dstWidth = static_cast<float>(sprite.dstRect.w);
+	const float dstHeight = static_cast<float>(sprite.dstRect.h);
+	const float scaleX = src.w / dstWidth;
+	const float scaleY = src.h / dstHeight;
+
+	for (int y = region.y; y < region.y + region.h; y++) {
+		// Rotate the pixel center back into the unrotated destination rectangle
+		const float dx = region.x + 0.5f - sprite.centerX;
+		const float dy = y + 0.5f - sprite.centerY;
+		float localX = dx * sprite.cosAngle + dy * sprite.sinAngle + dstWidth * 0.5f;
+		float localY = dy * sprite.cosAngle - dx * sprite.sinAngle + dstHeight * 0.5f;
+
+		// Gather the texels, pixels outside of the sprite are fully transparent
+		for (int i = 0; i < region.w; i++) {
+			if (localX >= 0.0f && localX < dstWidth && localY >= 0.0f && localY < dstHeight) {
+				const int srcX = std::min(static_cast<int>(localX * scaleX), src.w - 1);
+				const int srcY = std::min(static_cast<int>(localY * scaleY), src.h - 1);
+				rowBuffer[i] = sprite.pixels[(src.y + srcY) * sprite.pitch + src.x + srcX];
+			}
+			else {
+				rowBuffer[i] = 0;
+			}
+			localX += sprite.cosAngle;
+			localY -= sprite.sinAngle;
+		}
+
+		blendRow(&framebuffer[y * width + region.x], rowBuffer, region.w);
+	}
+}
+
+void SoftwareRenderBackend::Present() {
+	if (!window) {
+		return;
+	}
+
+	SDL_Surface* windowSurface = SDL_GetWindowSurface(window);
+	if (windowSurface) {
+		SDL_BlitSurface(framebufferSurface, NULL, windowSurface, NULL);
+		SDL_UpdateWindowSurface(window);
+	}
+}
+
+SDL_Surface* SoftwareRenderBackend::ReadPixels() {
+	return SDL_ConvertSurfaceFormat(framebufferSurface, SDL_PIXELFORMAT_RGBA32, 0);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "RenderBackend.h"
+#include "BlendKernels.h"
+#include "../AssetStore/AssetStore.h"
+#include "../JobSystem/JobSystem.h"
+
+// CPU rasterizer drawing into an RGBA32 framebuffer.
+// Sprites are binned into screen tiles and the tiles are rasterized in parallel on the job system.
+// Textures are read from the pixel copies the AssetStore keeps when SetKeepPixels is enabled.
+class SoftwareRenderBackend: public IRenderBackend
+{
+private:
+	// A sprite transformed to screen space, ready to be rasterized in any tile it overlaps
+	struct PreparedSprite {
+		const uint32_t* pixels;
+		// Row length of the texture in pixels
+		int pitch;
+		SDL_Rect srcRect;
+		SDL_Rect dstRect;
+		// Screen space bounding box clipped to the framebuffer
+		SDL_Rect bounds;
+		bool isRotated;
+		float cosAngle;
+		float sinAngle;
+		float centerX;
+		float centerY;
+	};
+
+	int width;
+	int height;
+	int tilesX;
+	int tilesY;
+	std::vector<uint32_t> framebuffer;
+	SDL_Surface* framebufferSurface;
+	// Window the frame is copied to on Present, null when running headless
+	SDL_Window* window;
+
+	const AssetStore& assetStore;
+	JobSystem& jobSystem;
+	BlendRowFunction blendRow;
+
+	uint32_t clearColor;
+	std::vector<PreparedSprite> preparedSprites;
+	// Indices into preparedSprites per tile, in submission order
+	std::vector<std::vector<uint32_t>> tileBins;
+	// Scratch row of gathered texels per worker thread
+	std::vector<std::vector<uint32_t>> rowBuffers;
+
+	void RasterizeTile(int tileIndex, int workerIndex);
+	void DrawAxisAligned(const PreparedSprite& sprite, const SDL_Rect& region, uint32_t* rowBuffer);
+	void DrawRotated(const PreparedSprite& sprite, const SDL_Rect& region, uint32_t* rowBuffer);
+
+public:
+	static const int TILE_SIZE = 64;
+
+	SoftwareRenderBackend(int width, int height, SDL_Window* window, const AssetStore& assetStore, JobSystem& jobSystem);
+	~SoftwareRenderBackend();
+
+	void BeginFrame(const SDL_Color& clearColor) override;
+	void DrawSprites(const std::vector<SpriteDrawCommand>& sprites) override;
+	void EndFrame() override;
+	void Present() override;
+	SDL_Surface* ReadPixels() override;
+};
@@ -0,0 +1,86 @@
+#include "BytecodeCache.h"
+#include "../AssetArchive/AssetArchive.h"
+#include "../Logger/Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+
+void BytecodeCache::SetDirectory(const std::string& directory) {
+	this->directory = directory;
+}
+
+bool BytecodeCache::IsEnabled() const {
+	return !directory.empty();
+}
+
+std::string BytecodeCache::GetCacheFilePath(const std::string& sourcePath) const {
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.luac", static_cast<unsigned long long>(AssetArchive::HashPath(sourcePath)));
+	return directory + "/" + fileName;
+}
+
+bool BytecodeCache::Load(const std::string& sourcePath, const char* source, size_t sourceSize, const char*& bytecode, size_t& bytecodeSize, std::unique_ptr<MappedFile>& mapping) const {
+	if (!IsEnabled()) {
+		return false;
+	}
+
+	const std::string cacheFilePath = GetCacheFilePath(sourcePath);
+	if (!std::filesystem::exists(cacheFilePath)) {
+		return false;
+	}
+
+	std::unique_ptr<MappedFile> cacheFile = std::make_unique<MappedFile>();
+	if (!cacheFile->Open(cacheFilePath) || cacheFile->GetSize() < sizeof(BytecodeCacheHeader)) {
+		return false;
+	}
+
+	// Scripts are small, hashing them is far cheaper than compiling them
+	const BytecodeCacheHeader* header = reinterpret_cast<const BytecodeCacheHeader*>(cacheFile->GetData());
+	if (header->magic != BYTECODE_CACHE_MAGIC || header->version != BYTECODE_CACHE_VERSION ||
+		header->sourceSize != sourceSize ||
+		header->bytecodeSize > cacheFile->GetSize() - sizeof(BytecodeCacheHeader) ||
+		header->sourceHash != AssetArchive::HashBytes(reinterpret_cast<const uint8_t*>(source), sourceSize)) {
+		return false;
+	}
+
+	bytecode = reinterpret_cast<const char*>(cacheFile->GetData() + sizeof(BytecodeCacheHeader));
+	bytecodeSize = static_cast<size_t>(header->bytecodeSize);
+	mapping = std::move(cacheFile);
+	return true;
+}
+
+void BytecodeCache::Store(const std::string& sourcePath, const char* source, size_t sourceSize, const std::vector<char>& bytecode) const {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	BytecodeCacheHeader header = {};
+	header.magic = BYTECODE_CACHE_MAGIC;
+	header.version = BYTECODE_CACHE_VERSION;
+	header.sourceSize = sourceSize;
+	header.sourceHash = AssetArchive::HashBytes(reinterpret_cast<const uint8_t*>(source), sourceSize);
+	header.bytecodeSize = bytecode.size();
+
+	// Written under a temporary name and renamed, so a reader never maps a half written file
+	const std::string cacheFilePath = GetCacheFilePath(sourcePath);
+	const std::string temporaryPath = cacheFilePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size()));
+		if (!file) {
+			MIRAGE_LOG_ERROR("Error writing bytecode cache file {}", temporaryPath);
+			file.close();
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryPath, cacheFilePath, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
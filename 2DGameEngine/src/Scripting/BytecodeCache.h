@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../AssetArchive/MappedFile.h"
+
+const uint32_t BYTECODE_CACHE_MAGIC = 0x43424C4D; // "MLBC"
+const uint32_t BYTECODE_CACHE_VERSION = 1;
+
+// Header of a cache file, the output of lua_dump follows it
+struct BytecodeCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	// The script the bytecode was compiled from, any difference invalidates the entry
+	uint64_t sourceSize;
+	uint64_t sourceHash;
+	uint64_t bytecodeSize;
+};
+
+// On disk cache of compiled Lua chunks, one file per script path that is memory mapped on load.
+// Lua checks the bytecode header itself, bytecode from another Lua version fails to load and is recompiled.
+class BytecodeCache
+{
+private:
+	std::string directory;
+
+	std::string GetCacheFilePath(const std::string& sourcePath) const;
+
+public:
+	// An empty directory disables the cache
+	void SetDirectory(const std::string& directory);
+	bool IsEnabled() const;
+
+	// Points bytecode into the mapped cache file, the mapping has to be kept alive while it is used.
+	// Returns false if there is no entry for this exact source.
+	bool Load(const std::string& sourcePath, const char* source, size_t sourceSize, const char*& bytecode, size_t& bytecodeSize, std::unique_ptr<MappedFile>& mapping) const;
+
+	// Writes the bytecode as the entry of the source
+	void Store(const std::string& sourcePath, const char* source, size_t sourceSize, const std::vector<char>& bytecode) const;
+};
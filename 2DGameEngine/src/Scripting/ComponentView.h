@@ -0,0 +1,88 @@
+#pragma once
+#include "../ECS/ECS.h"
+#include "EntityBatch.h"
+
+// The components of one type of every entity of a batch. Only valid while neither the pool nor the batch
+// changed, IsStale detects the pool being reallocated or entities being added or removed. The batch itself
+// has to outlive it, which the script system guarantees by never moving its batches.
+template <typename TComponent>
+class BatchComponents {
+private:
+	const EntityBatch* batch;
+	uint32_t batchVersion;
+	Pool<TComponent>* pool;
+	uint32_t poolVersion;
+
+public:
+	BatchComponents(const EntityBatch& batch): batch(&batch), batchVersion(batch.version) {
+		pool = batch.entities.empty() ? nullptr : batch.entities[0].registry->template GetComponentPool<TComponent>();
+		poolVersion = pool ? pool->GetVersion() : 0;
+	}
+
+	bool IsStale() const {
+		return batch->version != batchVersion || (pool && pool->GetVersion() != poolVersion);
+	}
+
+	int GetCount() const {
+		return batch->GetCount();
+	}
+
+	// Indices are 1 based, returns nullptr for indices out of range and entities without the component
+	TComponent* Get(int index) const {
+		if (!pool || index < 1 || index > batch->GetCount()) {
+			return nullptr;
+		}
+		const Entity& entity = batch->entities[index - 1];
+		if (!entity.HasComponent<TComponent>()) {
+			return nullptr;
+		}
+		return &pool->Get(entity.GetId());
+	}
+};
+
+// Zero copy view of one component field over every entity of a batch, like the positions of all transforms.
+// Elements are read and written in the pool storage in place, the pointers Get returns must not outlive the call.
+template <typename TComponent, typename TField>
+class ComponentView {
+private:
+	BatchComponents<TComponent> components;
+	TField TComponent::* field;
+
+public:
+	ComponentView(const EntityBatch& batch, TField TComponent::* field): components(batch), field(field) {}
+
+	bool IsStale() const {
+		return components.IsStale();
+	}
+
+	int GetCount() const {
+		return components.GetCount();
+	}
+
+	// Indices are 1 based, returns nullptr for indices out of range and entities without the component
+	TField* Get(int index) const {
+		TComponent* component = components.Get(index);
+		return component ? &(component->*field) : nullptr;
+	}
+};
+
+// The component of one entity of a batch, handed to Lua instead of a reference into the pool. Every access
+// checks the pool and the batch again, so a handle kept too long fails instead of touching freed memory.
+template <typename TComponent>
+class ComponentHandle {
+private:
+	BatchComponents<TComponent> components;
+	int index;
+
+public:
+	ComponentHandle(const EntityBatch& batch, int index): components(batch), index(index) {}
+
+	bool IsStale() const {
+		return components.IsStale();
+	}
+
+	// Returns nullptr once the entity lost the component
+	TComponent* Get() const {
+		return components.Get(index);
+	}
+};
@@ -0,0 +1,184 @@
+#include "CoroutineScheduler.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+CoroutineScheduler::CoroutineScheduler(lua_State* lua): lua(lua) {
+	lua_register(lua, "wait", &CoroutineScheduler::Wait);
+}
+
+CoroutineScheduler::~CoroutineScheduler() {
+	for (Coroutine& coroutine : coroutines) {
+		if (coroutine.isRunning) {
+			luaL_unref(lua, LUA_REGISTRYINDEX, coroutine.threadReference);
+		}
+	}
+	for (PooledThread& pooledThread : idleThreads) {
+		luaL_unref(lua, LUA_REGISTRYINDEX, pooledThread.threadReference);
+	}
+}
+
+// wait(seconds) yields the seconds to the scheduler, which resumes the coroutine once they passed.
+// Without seconds it sleeps until the next tick.
+int CoroutineScheduler::Wait(lua_State* thread) {
+	if (!lua_isyieldable(thread)) {
+		return luaL_error(thread, "wait can only be called from the run function of a behaviour");
+	}
+	lua_Number seconds = luaL_optnumber(thread, 1, 0.0);
+	lua_settop(thread, 0);
+	lua_pushnumber(thread, seconds);
+	return lua_yield(thread, 1);
+}
+
+CoroutineScheduler::PooledThread CoroutineScheduler::AcquireThread() {
+	if (!idleThreads.empty()) {
+		PooledThread pooledThread = idleThreads.back();
+		idleThreads.pop_back();
+		return pooledThread;
+	}
+	lua_State* thread = lua_newthread(lua);
+	// Pops the thread and anchors it in the registry, so the GC never collects it while pooled
+	int threadReference = luaL_ref(lua, LUA_REGISTRYINDEX);
+	return { thread, threadReference };
+}
+
+void CoroutineScheduler::ReleaseThread(Coroutine& coroutine) {
+	// Unwinds a suspended or failed coroutine and closes its upvalues so the thread starts clean next time
+	lua_resetthread(coroutine.thread);
+	if (lua_status(coroutine.thread) == LUA_OK) {
+		lua_settop(coroutine.thread, 0);
+		idleThreads.push_back({ coroutine.thread, coroutine.threadReference });
+	}
+	else {
+		luaL_unref(lua, LUA_REGISTRYINDEX, coroutine.threadReference);
+	}
+
+	coroutine.thread = nullptr;
+	coroutine.threadReference = LUA_NOREF;
+	coroutine.isRunning = false;
+	numRunning--;
+}
+
+void CoroutineScheduler::Schedule(int coroutineId, uint64_t wakeTick) {
+	timerWheel[wakeTick % TIMER_WHEEL_SLOTS].push_back({ coroutineId, coroutines[coroutineId].generation, wakeTick });
+}
+
+int CoroutineScheduler::Start(const sol::protected_function& function, int behaviourId, Entity entity) {
+	int coroutineId;
+	if (!freeCoroutineIds.empty()) {
+		coroutineId = freeCoroutineIds.back();
+		freeCoroutineIds.pop_back();
+	}
+	else {
+		coroutineId = static_cast<int>(coroutines.size());
+		coroutines.push_back({ nullptr, LUA_NOREF, -1, -1, 0, false, false });
+	}
+
+	PooledThread pooledThread = AcquireThread();
+	Coroutine& coroutine = coroutines[coroutineId];
+	coroutine.thread = pooledThread.thread;
+	coroutine.threadReference = pooledThread.threadReference;
+	coroutine.behaviourId = behaviourId;
+	coroutine.entityId = entity.GetId();
+	coroutine.generation++;
+	coroutine.isRunning = true;
+	coroutine.hasStarted = false;
+	numRunning++;
+
+	// The function and its argument wait on the thread's stack until the first resume
+	function.push(coroutine.thread);
+	sol::stack::push(coroutine.thread, entity);
+
+	// Entities are started while the registry updates, the script only runs from the next tick on
+	Schedule(coroutineId, currentTick + 1);
+	return coroutineId;
+}
+
+void CoroutineScheduler::Stop(int coroutineId, Entity entity) {
+	if (coroutineId < 0 || coroutineId >= static_cast<int>(coroutines.size())) {
+		return;
+	}
+	Coroutine& coroutine = coroutines[coroutineId];
+	if (!coroutine.isRunning || coroutine.entityId != entity.GetId()) {
+		return;
+	}
+	// Its timer stays in the wheel and is skipped once reached
+	ReleaseThread(coroutine);
+	freeCoroutineIds.push_back(coroutineId);
+}
+
+void CoroutineScheduler::StopBehaviour(int behaviourId) {
+	for (int coroutineId = 0; coroutineId < static_cast<int>(coroutines.size()); coroutineId++) {
+		Coroutine& coroutine = coroutines[coroutineId];
+		if (coroutine.isRunning && coroutine.behaviourId == behaviourId) {
+			ReleaseThread(coroutine);
+			freeCoroutineIds.push_back(coroutineId);
+		}
+	}
+}
+
+void CoroutineScheduler::Resume(int coroutineId) {
+	Coroutine& coroutine = coroutines[coroutineId];
+	lua_State* thread = coroutine.thread;
+	const int numArguments = coroutine.hasStarted ? 0 : 1;
+	coroutine.hasStarted = true;
+
+	// Hooks are per thread, the profiler only arms the main thread on the ticks it samples
+	lua_sethook(thread, lua_gethook(lua), lua_gethookmask(lua), lua_gethookcount(lua));
+
+	int numResults = 0;
+	int status = lua_resume(thread, lua, numArguments, &numResults);
+
+	if (status == LUA_YIELD) {
+		lua_Number seconds = numResults > 0 ? lua_tonumber(thread, -1) : 0.0;
+		lua_pop(thread, numResults);
+		// Rounded up so a wait never ends early, and at least one tick so a loop of waits can not stall the tick
+		uint64_t ticks = 1;
+		if (seconds > 0.0 && tickSeconds > 0.0) {
+			ticks = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(seconds / tickSeconds - 1e-9)));
+		}
+		Schedule(coroutineId, currentTick + ticks);
+		return;
+	}
+
+	if (status != LUA_OK) {
+		// The stack of a failed coroutine is not unwound, so the traceback still shows where it failed
+		const char* message = lua_tostring(thread, -1);
+		luaL_traceback(lua, thread, message ? message : "error object is not a string", 0);
+		failures.push_back({ coroutine.behaviourId, coroutine.entityId, lua_tostring(lua, -1) });
+		lua_pop(lua, 1);
+	}
+
+	// Returned or failed, the thread goes back to the pool
+	ReleaseThread(coroutine);
+	freeCoroutineIds.push_back(coroutineId);
+}
+
+int CoroutineScheduler::Update(double deltaTime) {
+	PROFILE_SCOPE("CoroutineScheduler::Update");
+	failures.clear();
+	tickSeconds = deltaTime;
+	currentTick++;
+
+	// Only this slot is touched, timers due in a later turn of the wheel are put back
+	std::vector<Timer>& slot = timerWheel[currentTick % TIMER_WHEEL_SLOTS];
+	dueTimers.swap(slot);
+
+	int numResumed = 0;
+	for (const Timer& timer : dueTimers) {
+		const Coroutine& coroutine = coroutines[timer.coroutineId];
+		if (!coroutine.isRunning || coroutine.generation != timer.generation) {
+			continue;
+		}
+		if (timer.wakeTick > currentTick) {
+			slot.push_back(timer);
+			continue;
+		}
+		Resume(timer.coroutineId);
+		numResumed++;
+	}
+	dueTimers.clear();
+
+	return numResumed;
+}
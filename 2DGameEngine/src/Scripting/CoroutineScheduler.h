@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ScriptEngine.h"
+
+// Number of ticks the timer wheel covers in one turn, longer waits stay in their slot for more turns
+const int TIMER_WHEEL_SLOTS = 256;
+
+// Error raised by a coroutine, handed to the caller so it can disable the behaviour
+struct CoroutineFailure {
+	int behaviourId;
+	int entityId;
+	std::string message;
+};
+
+// Runs one Lua coroutine per entity and wakes them on the simulation tick they asked for with wait(seconds).
+// Sleeping coroutines sit in a timer wheel slot and cost nothing until the wheel reaches them, so a tick only
+// touches the coroutines that wake in it. Lua threads are pooled, finished coroutines hand theirs back.
+class CoroutineScheduler
+{
+private:
+	struct Coroutine {
+		lua_State* thread;
+		// Registry reference keeping the thread alive while it is in use or pooled
+		int threadReference;
+		int behaviourId;
+		int entityId;
+		// Incremented on every start, timers of an earlier coroutine in the same slot are ignored
+		uint32_t generation;
+		bool isRunning;
+		// False until the first resume, which passes the entity to the function
+		bool hasStarted;
+	};
+
+	struct Timer {
+		int coroutineId;
+		uint32_t generation;
+		uint64_t wakeTick;
+	};
+
+	struct PooledThread {
+		lua_State* thread;
+		int threadReference;
+	};
+
+	lua_State* lua;
+	std::vector<Coroutine> coroutines;
+	std::vector<int> freeCoroutineIds;
+	std::vector<PooledThread> idleThreads;
+	std::vector<Timer> timerWheel[TIMER_WHEEL_SLOTS];
+	// Timers taken out of the current slot, kept as a member so its capacity is reused
+	std::vector<Timer> dueTimers;
+	uint64_t currentTick = 0;
+	double tickSeconds = 0.0;
+	int numRunning = 0;
+	std::vector<CoroutineFailure> failures;
+
+	static int Wait(lua_State* thread);
+
+	PooledThread AcquireThread();
+	void ReleaseThread(Coroutine& coroutine);
+	void Schedule(int coroutineId, uint64_t wakeTick);
+	void Resume(int coroutineId);
+
+public:
+	CoroutineScheduler(lua_State* lua);
+	~CoroutineScheduler();
+
+	CoroutineScheduler(const CoroutineScheduler&) = delete;
+	CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+	// Starts function(entity) as a coroutine on the next tick, returns the coroutine id
+	int Start(const sol::protected_function& function, int behaviourId, Entity entity);
+	// Stops the coroutine if it still runs for the entity, a sleeping one is never resumed again.
+	// Ids of stopped coroutines are reused, the entity keeps a stale id from stopping another one.
+	void Stop(int coroutineId, Entity entity);
+	// Stops every coroutine of a behaviour
+	void StopBehaviour(int behaviourId);
+
+	// Advances one tick and resumes the coroutines waking in it, returns the number resumed
+	int Update(double deltaTime);
+
+	// Errors raised by coroutines during the last Update, the failed coroutines are already stopped
+	const std::vector<CoroutineFailure>& GetFailures() const {
+		return failures;
+	}
+
+	int GetNumRunning() const {
+		return numRunning;
+	}
+
+	int GetNumPooledThreads() const {
+		return static_cast<int>(idleThreads.size());
+	}
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+
+// Structural changes requested by a behaviour. They are queued on the batch and applied by the script system
+// after every behaviour ran, so behaviours running in parallel never touch the registry.
+enum ScriptCommandType {
+	SCRIPT_COMMAND_KILL
+};
+
+struct ScriptCommand {
+	ScriptCommandType type;
+	Entity entity;
+};
+
+// Every entity using one behaviour, or a range of them for behaviours running in parallel, handed to the
+// behaviour in a single call per tick.
+// Indices are 1 based like Lua arrays.
+struct EntityBatch {
+	std::vector<Entity> entities;
+	// Position of every entity in entities by entity id, so removing one does not search the batch
+	std::unordered_map<int, int> entityIndices;
+	// Incremented whenever entities are added or removed, views over the batch compare it
+	uint32_t version = 0;
+	// Filled by Lua during the call and emptied by whoever applies the commands
+	std::vector<ScriptCommand> commands;
+
+	void Add(Entity entity) {
+		entityIndices[entity.GetId()] = static_cast<int>(entities.size());
+		entities.push_back(entity);
+		version++;
+	}
+
+	// Moves the last entity into the gap, so the order of the entities is not kept
+	void Remove(Entity entity) {
+		auto found = entityIndices.find(entity.GetId());
+		if (found == entityIndices.end()) {
+			return;
+		}
+		const int index = found->second;
+		entityIndices.erase(found);
+		if (index != static_cast<int>(entities.size()) - 1) {
+			entities[index] = entities.back();
+			entityIndices[entities[index].GetId()] = index;
+		}
+		entities.pop_back();
+		version++;
+	}
+
+	// Replaces the entities, used for batches covering a range of a larger one
+	void Assign(std::vector<Entity>::const_iterator first, std::vector<Entity>::const_iterator last) {
+		entities.assign(first, last);
+		entityIndices.clear();
+		for (int index = 0; index < static_cast<int>(entities.size()); index++) {
+			entityIndices[entities[index].GetId()] = index;
+		}
+		version++;
+	}
+
+	int GetCount() const {
+		return static_cast<int>(entities.size());
+	}
+
+	// Returns -1 for indices out of range
+	int GetId(int index) const {
+		if (index < 1 || index > GetCount()) {
+			return -1;
+		}
+		return entities[index - 1].GetId();
+	}
+
+	// Queues the entity to be killed, returns false for indices out of range
+	bool Kill(int index) {
+		if (index < 1 || index > GetCount()) {
+			return false;
+		}
+		commands.push_back({ SCRIPT_COMMAND_KILL, entities[index - 1] });
+		return true;
+	}
+};
@@ -0,0 +1,111 @@
+#include "LuaAllocator.h"
+#include <cstdlib>
+#include <cstring>
+
+LuaAllocator::~LuaAllocator() {
+	for (void* chunk : chunks) {
+		free(chunk);
+	}
+}
+
+// Returns -1 for blocks too large for the pools
+int LuaAllocator::GetSizeClass(size_t size) {
+	for (int sizeClass = 0; sizeClass < LUA_ALLOCATOR_NUM_SIZE_CLASSES; sizeClass++) {
+		if (size <= LUA_ALLOCATOR_SIZE_CLASSES[sizeClass]) {
+			return sizeClass;
+		}
+	}
+	return -1;
+}
+
+bool LuaAllocator::RefillPool(int sizeClass) {
+	char* chunk = static_cast<char*>(malloc(LUA_ALLOCATOR_CHUNK_BYTES));
+	if (!chunk) {
+		return false;
+	}
+	chunks.push_back(chunk);
+
+	const size_t blockSize = LUA_ALLOCATOR_SIZE_CLASSES[sizeClass];
+	for (size_t offset = 0; offset + blockSize <= LUA_ALLOCATOR_CHUNK_BYTES; offset += blockSize) {
+		PoolBlock* block = reinterpret_cast<PoolBlock*>(chunk + offset);
+		block->next = freeLists[sizeClass];
+		freeLists[sizeClass] = block;
+	}
+	return true;
+}
+
+void* LuaAllocator::AllocateBlock(size_t size) {
+	int sizeClass = GetSizeClass(size);
+	if (sizeClass < 0) {
+		return malloc(size);
+	}
+	if (!freeLists[sizeClass] && !RefillPool(sizeClass)) {
+		return nullptr;
+	}
+	PoolBlock* block = freeLists[sizeClass];
+	freeLists[sizeClass] = block->next;
+	return block;
+}
+
+void LuaAllocator::FreeBlock(void* block, size_t size) {
+	int sizeClass = GetSizeClass(size);
+	if (sizeClass < 0) {
+		free(block);
+		return;
+	}
+	PoolBlock* freeBlock = static_cast<PoolBlock*>(block);
+	freeBlock->next = freeLists[sizeClass];
+	freeLists[sizeClass] = freeBlock;
+}
+
+void* LuaAllocator::Allocate(void* userData, void* block, size_t oldSize, size_t newSize) {
+	LuaAllocator& allocator = *static_cast<LuaAllocator*>(userData);
+	// Without a block Lua passes the type of the new object instead of a size
+	if (!block) {
+		oldSize = 0;
+	}
+
+	if (newSize == 0) {
+		if (block) {
+			allocator.FreeBlock(block, oldSize);
+			allocator.heapBytes -= oldSize;
+		}
+		return nullptr;
+	}
+
+	int oldSizeClass = block ? GetSizeClass(oldSize) : -1;
+	int newSizeClass = GetSizeClass(newSize);
+	void* newBlock;
+	if (block && oldSizeClass == newSizeClass && newSizeClass >= 0) {
+		// Still fits the same block
+		newBlock = block;
+	}
+	else if (block && oldSizeClass < 0 && newSizeClass < 0) {
+		newBlock = realloc(block, newSize);
+		if (!newBlock) {
+			return nullptr;
+		}
+	}
+	else {
+		newBlock = allocator.AllocateBlock(newSize);
+		if (!newBlock && newSize > oldSize) {
+			return nullptr;
+		}
+		if (!newBlock) {
+			// Lua expects shrinking to succeed, the old block is large enough. It is freed as the new
+			// size later, a malloc block then simply joins a pool.
+			newBlock = block;
+		}
+		else if (block) {
+			memcpy(newBlock, block, oldSize < newSize ? oldSize : newSize);
+			allocator.FreeBlock(block, oldSize);
+		}
+	}
+
+	allocator.heapBytes += newSize;
+	allocator.heapBytes -= oldSize;
+	if (newSize > oldSize) {
+		allocator.allocatedBytes += newSize - oldSize;
+	}
+	return newBlock;
+}
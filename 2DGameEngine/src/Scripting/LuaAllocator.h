@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Block sizes of the pools, most of a Lua heap is small strings, tables, closures and userdata
+const size_t LUA_ALLOCATOR_SIZE_CLASSES[] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+const int LUA_ALLOCATOR_NUM_SIZE_CLASSES = sizeof(LUA_ALLOCATOR_SIZE_CLASSES) / sizeof(LUA_ALLOCATOR_SIZE_CLASSES[0]);
+// Pools grow by this much at a time
+const size_t LUA_ALLOCATOR_CHUNK_BYTES = 64 * 1024;
+
+// lua_Alloc for one Lua state. Blocks up to the largest size class come from free lists carved out of large
+// chunks, so the many small allocations of scripts never reach malloc once the pools are warm. Larger blocks
+// go to malloc. Freed blocks stay in their pool for reuse, chunks are only released with the allocator.
+// Not thread safe, like the state using it.
+class LuaAllocator
+{
+private:
+	struct PoolBlock {
+		PoolBlock* next;
+	};
+
+	PoolBlock* freeLists[LUA_ALLOCATOR_NUM_SIZE_CLASSES] = {};
+	std::vector<void*> chunks;
+	size_t heapBytes = 0;
+	size_t allocatedBytes = 0;
+
+	static int GetSizeClass(size_t size);
+	void* AllocateBlock(size_t size);
+	void FreeBlock(void* block, size_t size);
+	bool RefillPool(int sizeClass);
+
+public:
+	LuaAllocator() = default;
+	~LuaAllocator();
+
+	LuaAllocator(const LuaAllocator&) = delete;
+	LuaAllocator& operator=(const LuaAllocator&) = delete;
+
+	// The lua_Alloc function, userData is the allocator
+	static void* Allocate(void* userData, void* block, size_t oldSize, size_t newSize);
+
+	// Bytes the state currently has allocated
+	size_t GetHeapBytes() const {
+		return heapBytes;
+	}
+
+	// Bytes allocated since the last call, for the allocation rate
+	size_t TakeAllocatedBytes() {
+		size_t bytes = allocatedBytes;
+		allocatedBytes = 0;
+		return bytes;
+	}
+
+	// Memory held by the pools, including free blocks
+	size_t GetPoolBytes() const {
+		return chunks.size() * LUA_ALLOCATOR_CHUNK_BYTES;
+	}
+};
@@ -0,0 +1,128 @@
+#include "LuaProfiler.h"
+#include <lua/lua.hpp>
+#include <cstdio>
+#include <cstring>
+
+LuaProfiler::LuaProfiler(lua_State* lua): lua(lua) {
+	// Every thread created from now on copies the extra space of the main thread, so the hook finds the
+	// profiler from coroutines too
+	*static_cast<LuaProfiler**>(lua_getextraspace(lua)) = this;
+}
+
+LuaProfiler::~LuaProfiler() {
+	SetSampleInterval(0);
+	*static_cast<LuaProfiler**>(lua_getextraspace(lua)) = nullptr;
+}
+
+void LuaProfiler::SetSampleInterval(int instructionsPerSample) {
+	this->instructionsPerSample = instructionsPerSample > 0 ? instructionsPerSample : 0;
+	// The next tick is sampled
+	tick = 0;
+	if (this->instructionsPerSample == 0 && isHooked) {
+		lua_sethook(lua, nullptr, 0, 0);
+		isHooked = false;
+	}
+}
+
+void LuaProfiler::BeginTick() {
+	if (instructionsPerSample == 0) {
+		return;
+	}
+
+	const bool isSampled = tick++ % LUA_PROFILER_SAMPLED_TICK_INTERVAL == 0;
+	if (isSampled) {
+		// Also restarts the instruction count
+		lua_sethook(lua, &LuaProfiler::Hook, LUA_MASKCOUNT, instructionsPerSample);
+	}
+	else if (isHooked) {
+		lua_sethook(lua, nullptr, 0, 0);
+	}
+	isHooked = isSampled;
+}
+
+void LuaProfiler::SetFunctionName(const char* source, int lineDefined, const std::string& name) {
+	const int sourceId = GetSourceId(source);
+	functionNames[(static_cast<uint64_t>(sourceId) << 32) | static_cast<uint32_t>(lineDefined)] = name;
+}
+
+void LuaProfiler::Reset() {
+	numSamples = 0;
+	hotspots.clear();
+	hotspotIndices.clear();
+}
+
+void LuaProfiler::Hook(lua_State* thread, lua_Debug* debug) {
+	LuaProfiler* profiler = *static_cast<LuaProfiler**>(lua_getextraspace(thread));
+	// Threads pooled while sampling was on keep the hook after it was stopped
+	if (profiler && profiler->instructionsPerSample > 0) {
+		profiler->Sample(thread, debug);
+	}
+}
+
+void LuaProfiler::Sample(lua_State* thread, lua_Debug* debug) {
+	// The hook only gets the event, the rest is filled in on request
+	if (!lua_getinfo(thread, "Sl", debug)) {
+		return;
+	}
+	numSamples++;
+
+	const int sourceId = GetSourceId(debug->source);
+	const uint64_t key = (static_cast<uint64_t>(sourceId) << 32) | static_cast<uint32_t>(debug->currentline);
+	auto existing = hotspotIndices.find(key);
+	if (existing != hotspotIndices.end()) {
+		hotspots[existing->second].hits++;
+		return;
+	}
+
+	// Names are found by looking at the calling instruction, which is only worth it for new lines
+	std::string function;
+	auto named = functionNames.find((static_cast<uint64_t>(sourceId) << 32) | static_cast<uint32_t>(debug->linedefined));
+	if (named != functionNames.end()) {
+		function = named->second;
+	}
+	else if (lua_getinfo(thread, "n", debug) && debug->name) {
+		function = debug->name;
+	}
+	else if (debug->what && std::strcmp(debug->what, "main") == 0) {
+		function = "main chunk";
+	}
+	else {
+		function = "function at line " + std::to_string(debug->linedefined);
+	}
+
+	hotspotIndices.emplace(key, static_cast<int>(hotspots.size()));
+	hotspots.push_back({ sourceId, debug->currentline, function, 1 });
+}
+
+int LuaProfiler::GetSourceId(const char* source) {
+	auto existing = sourceIds.find(source);
+	if (existing != sourceIds.end() && sources[existing->second] == source) {
+		return existing->second;
+	}
+
+	for (int sourceId = 0; sourceId < static_cast<int>(sources.size()); sourceId++) {
+		if (sources[sourceId] == source) {
+			sourceIds[source] = sourceId;
+			return sourceId;
+		}
+	}
+
+	sources.push_back(source);
+	sourceIds[source] = static_cast<int>(sources.size()) - 1;
+	return static_cast<int>(sources.size()) - 1;
+}
+
+void LuaProfiler::GetHotspots(std::vector<LuaHotspot>& result) const {
+	for (const Hotspot& hotspot : hotspots) {
+		// Chunk names of files start with @, only the file name is shown
+		const std::string& source = sources[hotspot.sourceId];
+		const size_t separator = source.find_last_of("/\\");
+		const char* fileName = separator != std::string::npos ? source.c_str() + separator + 1 : source.c_str() + (source[0] == '@' ? 1 : 0);
+
+		LuaHotspot luaHotspot;
+		snprintf(luaHotspot.function, sizeof(luaHotspot.function), "%s", hotspot.function.c_str());
+		snprintf(luaHotspot.location, sizeof(luaHotspot.location), "%s:%d", fileName, hotspot.line);
+		luaHotspot.hits = hotspot.hits;
+		result.push_back(luaHotspot);
+	}
+}
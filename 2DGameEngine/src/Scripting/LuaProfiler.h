@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct lua_State;
+struct lua_Debug;
+
+// VM instructions between two samples on a sampled tick
+const int LUA_PROFILER_SAMPLE_INSTRUCTIONS = 1000;
+// Only one simulation tick in this many is sampled. With a hook set Lua checks it on every instruction,
+// which makes scripts about twice as slow regardless of the sample interval.
+const int LUA_PROFILER_SAMPLED_TICK_INTERVAL = 8;
+const int LUA_HOTSPOT_FUNCTION_LENGTH = 32;
+const int LUA_HOTSPOT_LOCATION_LENGTH = 64;
+
+// A line scripts spend their time in, fixed size so reports can be copied around without allocating
+struct LuaHotspot {
+	char function[LUA_HOTSPOT_FUNCTION_LENGTH];
+	// Script and line, like bounce.lua:17
+	char location[LUA_HOTSPOT_LOCATION_LENGTH];
+	uint64_t hits;
+};
+
+// Sampling profiler of one Lua state. On sampled ticks a count hook interrupts the VM every thousand or so
+// instructions and counts a hit for the function and line it was running, so hits are proportional to the
+// instructions spent there. Time spent in C functions called from Lua is not seen. Not thread safe, like the
+// state using it.
+class LuaProfiler
+{
+private:
+	struct Hotspot {
+		int sourceId;
+		int line;
+		std::string function;
+		uint64_t hits;
+	};
+
+	lua_State* lua;
+	int instructionsPerSample = 0;
+	uint64_t tick = 0;
+	bool isHooked = false;
+	uint64_t numSamples = 0;
+	// Chunk names by id, looked up by the address Lua keeps them at and compared on every hit in case a
+	// reloaded script got the address of an older one
+	std::vector<std::string> sources;
+	std::unordered_map<const char*, int> sourceIds;
+	// Flat table of every sampled line, keyed by source id and line
+	std::vector<Hotspot> hotspots;
+	std::unordered_map<uint64_t, int> hotspotIndices;
+	// Names given by the engine, keyed by source id and the line a function is defined at. Lua can only name
+	// functions from the calling instruction, which does not exist for functions called from C.
+	std::unordered_map<uint64_t, std::string> functionNames;
+
+	static void Hook(lua_State* thread, lua_Debug* debug);
+	void Sample(lua_State* thread, lua_Debug* debug);
+	int GetSourceId(const char* source);
+
+public:
+	LuaProfiler(lua_State* lua);
+	~LuaProfiler();
+
+	LuaProfiler(const LuaProfiler&) = delete;
+	LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+	// 0 stops sampling. Only the main thread is hooked, coroutines have to copy its hook before resuming.
+	void SetSampleInterval(int instructionsPerSample);
+	// Sets or removes the hook depending on whether the tick is sampled, called before any script of the tick runs
+	void BeginTick();
+	// Names the function for reports, source and line are those lua_getinfo reports for it
+	void SetFunctionName(const char* source, int lineDefined, const std::string& name);
+	bool IsSampling() const {
+		return instructionsPerSample > 0;
+	}
+	void Reset();
+
+	uint64_t GetNumSamples() const {
+		return numSamples;
+	}
+
+	// Appends a hotspot for every sampled line, in no particular order
+	void GetHotspots(std::vector<LuaHotspot>& result) const;
+};
@@ -0,0 +1,585 @@
+#include "ScriptEngine.h"
+#include "ComponentView.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <tuple>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+// Errors thrown from bindings are turned into Lua errors by sol, the failing behaviour is then disabled
+template <typename TView>
+static auto GetViewElement(const TView& view, int index) {
+	if (view.IsStale()) {
+		throw sol::error("stale component view, views are only valid until entities or components are added or removed");
+	}
+	return view.Get(index);
+}
+
+template <typename TComponent>
+static TComponent& GetHandleComponent(const ComponentHandle<TComponent>& handle) {
+	if (handle.IsStale()) {
+		throw sol::error("stale component, components of a batch are only valid until entities or components are added or removed");
+	}
+	TComponent* component = handle.Get();
+	if (!component) {
+		throw sol::error("the entity no longer has the component");
+	}
+	return *component;
+}
+
+template <typename TComponent>
+static TComponent& GetEntityComponent(const Entity& entity) {
+	if (!entity.HasComponent<TComponent>()) {
+		throw sol::error("entity id " + std::to_string(entity.GetId()) + " does not have the component");
+	}
+	return entity.GetComponent<TComponent>();
+}
+
+// Checked here even without sol safeties, a nil vec2 would be dereferenced otherwise
+static glm::vec2 GetVec2(const sol::stack_object& value) {
+	if (!value.is<glm::vec2>()) {
+		throw sol::error("expected a vec2");
+	}
+	return value.as<glm::vec2>();
+}
+
+// view[i] returns a copy of the element, get and set only move numbers so hot loops allocate nothing
+template <typename TComponent>
+static void RegisterVec2View(sol::state& lua, const char* name) {
+	typedef ComponentView<TComponent, glm::vec2> View;
+	lua.new_usertype<View>(name,
+		sol::no_constructor,
+		sol::meta_function::length, &View::GetCount,
+		sol::meta_function::index, [](const View& view, int index) {
+			const glm::vec2* element = GetViewElement(view, index);
+			return element ? sol::optional<glm::vec2>(*element) : sol::optional<glm::vec2>();
+		},
+		sol::meta_function::new_index, [](const View& view, int index, const sol::stack_object& value) {
+			glm::vec2* element = GetViewElement(view, index);
+			if (!element) {
+				throw sol::error("no component at index " + std::to_string(index));
+			}
+			*element = GetVec2(value);
+		},
+		"get", [](const View& view, int index) {
+			const glm::vec2* element = GetViewElement(view, index);
+			if (!element) {
+				return std::make_tuple(sol::optional<float>(), sol::optional<float>());
+			}
+			return std::make_tuple(sol::optional<float>(element->x), sol::optional<float>(element->y));
+		},
+		"set", [](const View& view, int index, float x, float y) {
+			glm::vec2* element = GetViewElement(view, index);
+			if (!element) {
+				throw sol::error("no component at index " + std::to_string(index));
+			}
+			element->x = x;
+			element->y = y;
+		}
+	);
+}
+
+template <typename TComponent>
+static void RegisterNumberView(sol::state& lua, const char* name) {
+	typedef ComponentView<TComponent, double> View;
+	lua.new_usertype<View>(name,
+		sol::no_constructor,
+		sol::meta_function::length, &View::GetCount,
+		sol::meta_function::index, [](const View& view, int index) {
+			const double* element = GetViewElement(view, index);
+			return element ? sol::optional<double>(*element) : sol::optional<double>();
+		},
+		sol::meta_function::new_index, [](const View& view, int index, double value) {
+			double* element = GetViewElement(view, index);
+			if (!element) {
+				throw sol::error("no component at index " + std::to_string(index));
+			}
+			*element = value;
+		}
+	);
+}
+
+// Lua can not name functions called from C, the profiler gets the names from the module instead
+static void NameFunction(LuaProfiler& profiler, const sol::protected_function& function, const std::string& name) {
+	if (!function.valid()) {
+		return;
+	}
+	lua_State* state = function.lua_state();
+	function.push();
+	lua_Debug debug;
+	// Pops the function
+	lua_getinfo(state, ">S", &debug);
+	profiler.SetFunctionName(debug.source, debug.linedefined, name);
+}
+
+ScriptEngine::ScriptEngine(const std::string& scriptDirectory): lua(sol::default_at_panic, &LuaAllocator::Allocate, &allocator), profiler(lua.lua_state()), scriptDirectory(scriptDirectory) {
+	lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::table);
+	// Scripts allocating would otherwise run collection steps in the middle of a tick
+	lua_gc(lua.lua_state(), LUA_GCSTOP);
+	heapBytesAfterCycle = allocator.GetHeapBytes();
+	RegisterBindings();
+	MIRAGE_LOG_INFO("ScriptEngine constructor called, {}", LUA_RELEASE);
+}
+
+ScriptEngine::~ScriptEngine() {
+	MIRAGE_LOG_INFO("ScriptEngine destructor called");
+}
+
+void ScriptEngine::RegisterBindings() {
+	lua.new_usertype<glm::vec2>("vec2",
+		sol::call_constructor, sol::constructors<glm::vec2(), glm::vec2(float, float)>(),
+		"x", &glm::vec2::x,
+		"y", &glm::vec2::y,
+		sol::meta_function::addition, [](const glm::vec2& a, const glm::vec2& b) { return a + b; },
+		sol::meta_function::subtraction, [](const glm::vec2& a, const glm::vec2& b) { return a - b; },
+		sol::meta_function::multiplication, [](const glm::vec2& a, float b) { return a * b; }
+	);
+
+	// Components of a batch are handed out as handles copying fields in and out by value, a reference into
+	// the pool could outlive the storage
+	typedef ComponentHandle<TransformComponent> TransformHandle;
+	lua.new_usertype<TransformHandle>("Transform",
+		sol::no_constructor,
+		"position", sol::property(
+			[](const TransformHandle& handle) { return GetHandleComponent(handle).position; },
+			[](const TransformHandle& handle, const sol::stack_object& value) { GetHandleComponent(handle).position = GetVec2(value); }
+		),
+		"scale", sol::property(
+			[](const TransformHandle& handle) { return GetHandleComponent(handle).scale; },
+			[](const TransformHandle& handle, const sol::stack_object& value) { GetHandleComponent(handle).scale = GetVec2(value); }
+		),
+		"rotation", sol::property(
+			[](const TransformHandle& handle) { return GetHandleComponent(handle).rotation; },
+			[](const TransformHandle& handle, double value) { GetHandleComponent(handle).rotation = value; }
+		)
+	);
+
+	typedef ComponentHandle<RigidBodyComponent> RigidBodyHandle;
+	lua.new_usertype<RigidBodyHandle>("RigidBody",
+		sol::no_constructor,
+		"velocity", sol::property(
+			[](const RigidBodyHandle& handle) { return GetHandleComponent(handle).velocity; },
+			[](const RigidBodyHandle& handle, const sol::stack_object& value) { GetHandleComponent(handle).velocity = GetVec2(value); }
+		)
+	);
+
+	// Handed to run functions. Components are copied in and out by value, a reference kept across a wait
+	// could point into a pool that has been reallocated in the meantime.
+	lua.new_usertype<Entity>("Entity",
+		sol::no_constructor,
+		"id", sol::readonly_property(&Entity::GetId),
+		"position", sol::property(
+			[](const Entity& entity) { return GetEntityComponent<TransformComponent>(entity).position; },
+			[](const Entity& entity, const sol::stack_object& value) { GetEntityComponent<TransformComponent>(entity).position = GetVec2(value); }
+		),
+		"rotation", sol::property(
+			[](const Entity& entity) { return GetEntityComponent<TransformComponent>(entity).rotation; },
+			[](const Entity& entity, double value) { GetEntityComponent<TransformComponent>(entity).rotation = value; }
+		),
+		"velocity", sol::property(
+			[](const Entity& entity) { return GetEntityComponent<RigidBodyComponent>(entity).velocity; },
+			[](const Entity& entity, const sol::stack_object& value) { GetEntityComponent<RigidBodyComponent>(entity).velocity = GetVec2(value); }
+		),
+		"kill", &Entity::Kill
+	);
+
+	RegisterVec2View<TransformComponent>(lua, "TransformVec2View");
+	RegisterNumberView<TransformComponent>(lua, "TransformNumberView");
+	RegisterVec2View<RigidBodyComponent>(lua, "RigidBodyVec2View");
+
+	// Single components as handles, nil for entities without the component, and views of one field over the
+	// whole batch for loops
+	lua.new_usertype<EntityBatch>("EntityBatch",
+		sol::no_constructor,
+		"count", sol::readonly_property(&EntityBatch::GetCount),
+		"id", &EntityBatch::GetId,
+		"transform", [](const EntityBatch& batch, int index) {
+			TransformHandle handle(batch, index);
+			return handle.Get() ? sol::optional<TransformHandle>(handle) : sol::optional<TransformHandle>();
+		},
+		"rigidbody", [](const EntityBatch& batch, int index) {
+			RigidBodyHandle handle(batch, index);
+			return handle.Get() ? sol::optional<RigidBodyHandle>(handle) : sol::optional<RigidBodyHandle>();
+		},
+		// Queued, the entity is killed after every behaviour ran
+		"kill", [](EntityBatch& batch, int index) {
+			if (!batch.Kill(index)) {
+				throw sol::error("no entity at index " + std::to_string(index));
+			}
+		},
+		"positions", sol::readonly_property([](const EntityBatch& batch) {
+			return ComponentView<TransformComponent, glm::vec2>(batch, &TransformComponent::position);
+		}),
+		"scales", sol::readonly_property([](const EntityBatch& batch) {
+			return ComponentView<TransformComponent, glm::vec2>(batch, &TransformComponent::scale);
+		}),
+		"rotations", sol::readonly_property([](const EntityBatch& batch) {
+			return ComponentView<TransformComponent, double>(batch, &TransformComponent::rotation);
+		}),
+		"velocities", sol::readonly_property([](const EntityBatch& batch) {
+			return ComponentView<RigidBodyComponent, glm::vec2>(batch, &RigidBodyComponent::velocity);
+		})
+	);
+}
+
+// lua_Writer appending the dumped chunk to a vector
+static int WriteBytecode(lua_State*, const void* data, size_t size, void* userData) {
+	std::vector<char>& bytecode = *static_cast<std::vector<char>*>(userData);
+	bytecode.insert(bytecode.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+	return 0;
+}
+
+void ScriptEngine::SetBytecodeCacheDirectory(const std::string& directory) {
+	bytecodeCache.SetDirectory(directory);
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->SetBytecodeCacheDirectory(directory);
+	}
+}
+
+void ScriptEngine::SetArchive(const AssetArchive* archive) {
+	this->archive = archive;
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->SetArchive(archive);
+	}
+}
+
+void ScriptEngine::CreateWorkerStates(int numThreads) {
+	if (!behaviours.empty()) {
+		MIRAGE_LOG_ERROR("Worker states have to be created before behaviours are loaded");
+		return;
+	}
+
+	for (int workerIndex = GetNumStates(); workerIndex < numThreads; workerIndex++) {
+		auto workerEngine = std::make_unique<ScriptEngine>(scriptDirectory);
+		workerEngine->bytecodeCache = bytecodeCache;
+		workerEngine->archive = archive;
+		workerEngine->SetProfilerSampleInterval(profilerSampleInterval);
+		for (const auto& global : globals) {
+			workerEngine->SetGlobal(global.first, global.second);
+		}
+		workerEngines.push_back(std::move(workerEngine));
+	}
+}
+
+void ScriptEngine::SetGlobal(const std::string& name, double value) {
+	lua[name] = value;
+	globals[name] = value;
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->SetGlobal(name, value);
+	}
+}
+
+sol::load_result ScriptEngine::LoadScript(const std::string& filePath) {
+	const std::string chunkName = "@" + filePath;
+
+	// Archives normally hold bytecode from CompileForArchive, but plain sources load as well
+	const uint8_t* archiveData;
+	size_t archiveSize;
+	if (archive && archive->Find(filePath, archiveData, archiveSize)) {
+		return lua.load_buffer(reinterpret_cast<const char*>(archiveData), archiveSize, chunkName, sol::load_mode::any);
+	}
+
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file) {
+		// Leaves the error for the caller to report
+		return lua.load_file(filePath);
+	}
+	const std::vector<char> source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	{
+		const char* bytecode;
+		size_t bytecodeSize;
+		std::unique_ptr<MappedFile> mapping;
+		if (bytecodeCache.Load(filePath, source.data(), source.size(), bytecode, bytecodeSize, mapping)) {
+			// Lua copies what it needs while loading, the mapping can go right after
+			sol::load_result cached = lua.load_buffer(bytecode, bytecodeSize, chunkName, sol::load_mode::binary);
+			if (cached.valid()) {
+				return cached;
+			}
+			// Bytecode of another Lua version or build, compiled again and replaced below
+		}
+	}
+
+	sol::load_result script = lua.load_buffer(source.data(), source.size(), chunkName, sol::load_mode::text);
+	if (script.valid() && bytecodeCache.IsEnabled()) {
+		// The loaded function is on top of the stack, debug information is kept for tracebacks
+		std::vector<char> bytecode;
+		lua_dump(lua.lua_state(), &WriteBytecode, &bytecode, 0);
+		bytecodeCache.Store(filePath, source.data(), source.size(), bytecode);
+	}
+	return script;
+}
+
+bool ScriptEngine::CompileForArchive(const std::string& filePath, std::vector<char>& contents) {
+	if (std::filesystem::path(filePath).extension() != ".lua") {
+		return true;
+	}
+
+	// Compiling needs no engine bindings, a bare state is enough
+	lua_State* state = luaL_newstate();
+	const std::string chunkName = "@" + filePath;
+	const bool isCompiled = luaL_loadbufferx(state, contents.data(), contents.size(), chunkName.c_str(), "t") == LUA_OK;
+	if (isCompiled) {
+		std::vector<char> bytecode;
+		lua_dump(state, &WriteBytecode, &bytecode, 0);
+		contents.swap(bytecode);
+	}
+	else {
+		MIRAGE_LOG_ERROR("Error compiling {}: {}", filePath, lua_tostring(state, -1));
+	}
+	lua_close(state);
+	return isCompiled;
+}
+
+int ScriptEngine::GetBehaviourId(const std::string& name) {
+	auto existing = behaviourIds.find(name);
+	if (existing != behaviourIds.end()) {
+		return existing->second;
+	}
+
+	const std::string filePath = scriptDirectory + "/" + name + ".lua";
+	int behaviourId = -1;
+
+	sol::load_result script = LoadScript(filePath);
+	if (!script.valid()) {
+		sol::error error = script;
+		MIRAGE_LOG_ERROR("Error loading behaviour {}: {}", filePath, error.what());
+	}
+	else {
+		sol::protected_function chunk = script;
+		sol::protected_function_result result = chunk();
+		if (!result.valid()) {
+			sol::error error = result;
+			MIRAGE_LOG_ERROR("Error running behaviour {}: {}", filePath, error.what());
+		}
+		else if (result.get_type() != sol::type::table) {
+			MIRAGE_LOG_ERROR("Behaviour {} does not return a table", filePath);
+		}
+		else {
+			sol::table module = result;
+			sol::optional<sol::protected_function> update = module.get<sol::optional<sol::protected_function>>("update");
+			sol::optional<sol::protected_function> run = module.get<sol::optional<sol::protected_function>>("run");
+			if (!update && !run) {
+				MIRAGE_LOG_ERROR("Behaviour {} has neither an update nor a run function", filePath);
+			}
+			else {
+				behaviourId = static_cast<int>(behaviours.size());
+				const char* zoneName = Profiler::InternName("Lua " + name + ".update");
+				behaviours.push_back({ name, module, update.value_or(sol::protected_function()), run.value_or(sol::protected_function()), zoneName, false, false });
+				NameFunction(profiler, behaviours.back().update, name + ".update");
+				NameFunction(profiler, behaviours.back().run, name + ".run");
+				MIRAGE_LOG_INFO("Loaded behaviour {}", name);
+
+				if (update && module.get_or("parallel", false) && !workerEngines.empty()) {
+					LoadIntoWorkers(behaviours.back());
+				}
+			}
+		}
+	}
+
+	behaviourIds.emplace(name, behaviourId);
+	return behaviourId;
+}
+
+void ScriptEngine::LoadIntoWorkers(Behaviour& behaviour) {
+	for (auto& workerEngine : workerEngines) {
+		int workerBehaviourId = workerEngine->GetBehaviourId(behaviour.name);
+		if (workerBehaviourId < 0 || !workerEngine->HasUpdate(workerBehaviourId)) {
+			MIRAGE_LOG_ERROR("Behaviour {} could not be loaded into every worker state, it runs serially", behaviour.name);
+			behaviour.workerBehaviourIds.clear();
+			return;
+		}
+		behaviour.workerBehaviourIds.push_back(workerBehaviourId);
+	}
+	behaviour.isParallel = true;
+}
+
+int ScriptEngine::GetNumBehaviours() const {
+	return static_cast<int>(behaviours.size());
+}
+
+bool ScriptEngine::CollectGarbage(double budgetMillisecs) {
+	const double stateBudgetMillisecs = budgetMillisecs / GetNumStates();
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->CollectGarbage(stateBudgetMillisecs);
+	}
+
+	lua_State* state = lua.lua_state();
+	const auto start = std::chrono::steady_clock::now();
+	const auto budget = std::chrono::duration<double, std::milli>(stateBudgetMillisecs);
+	const bool isOverGrowthLimit = allocator.GetHeapBytes() > std::max(heapBytesAfterCycle, LUA_GC_MIN_HEAP_BYTES) * LUA_GC_HEAP_GROWTH_LIMIT;
+
+	// A step of size 0 is one basic step of the incremental collector, small enough to check the clock after each
+	while (isOverGrowthLimit || std::chrono::steady_clock::now() - start < budget) {
+		if (lua_gc(state, LUA_GCSTEP, 0)) {
+			heapBytesAfterCycle = allocator.GetHeapBytes();
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t ScriptEngine::GetHeapBytes() const {
+	size_t heapBytes = allocator.GetHeapBytes();
+	for (const auto& workerEngine : workerEngines) {
+		heapBytes += workerEngine->allocator.GetHeapBytes();
+	}
+	return heapBytes;
+}
+
+size_t ScriptEngine::TakeAllocatedBytes() {
+	size_t allocatedBytes = allocator.TakeAllocatedBytes();
+	for (auto& workerEngine : workerEngines) {
+		allocatedBytes += workerEngine->allocator.TakeAllocatedBytes();
+	}
+	return allocatedBytes;
+}
+
+bool ScriptEngine::HasUpdate(int behaviourId) const {
+	return behaviours[behaviourId].update.valid();
+}
+
+bool ScriptEngine::IsParallel(int behaviourId) const {
+	return behaviours[behaviourId].isParallel;
+}
+
+bool ScriptEngine::IsDisabled(int behaviourId) const {
+	return behaviours[behaviourId].hasFailed;
+}
+
+const sol::protected_function* ScriptEngine::GetRoutine(int behaviourId) const {
+	const Behaviour& behaviour = behaviours[behaviourId];
+	if (behaviour.hasFailed || !behaviour.run.valid()) {
+		return nullptr;
+	}
+	return &behaviour.run;
+}
+
+bool ScriptEngine::RunBehaviour(int behaviourId, EntityBatch& batch, double deltaTime) {
+	Behaviour& behaviour = behaviours[behaviourId];
+	if (behaviour.hasFailed) {
+		return false;
+	}
+
+	std::string error;
+	if (!CallUpdate(behaviour, batch, deltaTime, error)) {
+		DisableBehaviour(behaviourId, error);
+		return false;
+	}
+	return true;
+}
+
+bool ScriptEngine::RunBehaviourOnWorker(int behaviourId, int workerIndex, EntityBatch& batch, double deltaTime, std::string& error) {
+	// Only read here, nothing changes the behaviours while workers run
+	Behaviour& behaviour = behaviours[behaviourId];
+	if (behaviour.hasFailed) {
+		return false;
+	}
+	if (workerIndex == 0) {
+		return CallUpdate(behaviour, batch, deltaTime, error);
+	}
+
+	ScriptEngine& workerEngine = *workerEngines[workerIndex - 1];
+	return workerEngine.CallUpdate(workerEngine.behaviours[behaviour.workerBehaviourIds[workerIndex - 1]], batch, deltaTime, error);
+}
+
+bool ScriptEngine::CallUpdate(Behaviour& behaviour, EntityBatch& batch, double deltaTime, std::string& error) {
+	PROFILE_SCOPE(behaviour.zoneName);
+
+	// The batch is passed by pointer, Lua sees the entities of this tick without a copy
+	sol::protected_function_result result = behaviour.update(&batch, deltaTime);
+	if (!result.valid()) {
+		sol::error luaError = result;
+		error = luaError.what();
+		return false;
+	}
+	return true;
+}
+
+void ScriptEngine::DisableBehaviour(int behaviourId, const std::string& error) {
+	Behaviour& behaviour = behaviours[behaviourId];
+	if (behaviour.hasFailed) {
+		return;
+	}
+	MIRAGE_LOG_ERROR("Error in behaviour {}, it is disabled: {}", behaviour.name, error);
+	behaviour.hasFailed = true;
+}
+
+void ScriptEngine::SetProfilerSampleInterval(int instructionsPerSample) {
+	profilerSampleInterval = instructionsPerSample;
+	profiler.SetSampleInterval(instructionsPerSample);
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->SetProfilerSampleInterval(instructionsPerSample);
+	}
+}
+
+void ScriptEngine::BeginProfilerTick() {
+	profiler.BeginTick();
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->BeginProfilerTick();
+	}
+}
+
+void ScriptEngine::ResetProfiler() {
+	profiler.Reset();
+	for (auto& workerEngine : workerEngines) {
+		workerEngine->ResetProfiler();
+	}
+}
+
+int ScriptEngine::GetTopHotspots(LuaHotspot* hotspots, int maxHotspots) const {
+	std::vector<LuaHotspot> sampled;
+	profiler.GetHotspots(sampled);
+	for (const auto& workerEngine : workerEngines) {
+		workerEngine->profiler.GetHotspots(sampled);
+	}
+
+	// Worker states run the same scripts, their hits on a line are added up
+	std::vector<LuaHotspot> merged;
+	std::unordered_map<std::string, size_t> mergedIndices;
+	for (const LuaHotspot& hotspot : sampled) {
+		auto inserted = mergedIndices.emplace(std::string(hotspot.location) + hotspot.function, merged.size());
+		if (inserted.second) {
+			merged.push_back(hotspot);
+		}
+		else {
+			merged[inserted.first->second].hits += hotspot.hits;
+		}
+	}
+
+	const int count = std::min(maxHotspots, static_cast<int>(merged.size()));
+	std::partial_sort(merged.begin(), merged.begin() + count, merged.end(), [](const LuaHotspot& a, const LuaHotspot& b) {
+		return a.hits > b.hits;
+	});
+	std::copy(merged.begin(), merged.begin() + count, hotspots);
+	return count;
+}
+
+uint64_t ScriptEngine::GetNumProfilerSamples() const {
+	uint64_t numSamples = profiler.GetNumSamples();
+	for (const auto& workerEngine : workerEngines) {
+		numSamples += workerEngine->profiler.GetNumSamples();
+	}
+	return numSamples;
+}
+
+void ScriptEngine::LogHotspots(int maxHotspots) const {
+	const uint64_t numSamples = GetNumProfilerSamples();
+	if (numSamples == 0) {
+		return;
+	}
+
+	std::vector<LuaHotspot> hotspots(maxHotspots);
+	const int count = GetTopHotspots(hotspots.data(), maxHotspots);
+	std::string table = "Lua hotspots, " + std::to_string(numSamples) + " samples";
+	for (int index = 0; index < count; index++) {
+		char row[160];
+		snprintf(row, sizeof(row), "\n%6.2f%%  %-32s %s", 100.0 * hotspots[index].hits / numSamples, hotspots[index].function, hotspots[index].location);
+		table += row;
+	}
+	MIRAGE_LOG_INFO("{}", table);
+}
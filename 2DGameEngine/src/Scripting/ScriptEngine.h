@@ -0,0 +1,153 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+// Checked conversions turn script type errors into Lua errors instead of crashes, but double the cost of
+// every call into C++, so they are only on in debug builds. Must be the same in every file including sol.
+#if !defined(SOL_ALL_SAFETIES_ON) && defined(_DEBUG)
+#define SOL_ALL_SAFETIES_ON 1
+#endif
+#include <sol/sol.hpp>
+#include "EntityBatch.h"
+#include "LuaAllocator.h"
+#include "BytecodeCache.h"
+#include "LuaProfiler.h"
+#include "../AssetArchive/AssetArchive.h"
+
+// The collector runs to the end of a cycle regardless of the budget once the heap grew this much
+// beyond its size after the last cycle, so garbage can not pile up when the budget is too small
+const double LUA_GC_HEAP_GROWTH_LIMIT = 2.0;
+// Heaps smaller than this never force a cycle
+const size_t LUA_GC_MIN_HEAP_BYTES = 1024 * 1024;
+
+// Owns the Lua state and the behaviour scripts. A behaviour is a Lua module returning a table with an
+// update(batch, deltaTime) function, which is called once per tick with every entity using the behaviour,
+// and or a run(entity) function, which runs as a coroutine per entity and can sleep with wait(seconds).
+// A module setting parallel = true promises that its update only touches the entities of the batch and keeps
+// no state between calls. Such behaviours are also loaded into one extra state per job worker and their
+// batches are split into ranges updated concurrently, every state sees only some of the entities.
+class ScriptEngine
+{
+private:
+	struct Behaviour {
+		std::string name;
+		sol::table module;
+		// Either may be missing, but not both
+		sol::protected_function update;
+		sol::protected_function run;
+		// Interned, profiler zones of update calls outlive the behaviour
+		const char* zoneName;
+		// Set after the first error, so a broken script does not log every tick
+		bool hasFailed;
+		bool isParallel;
+		// Id of the behaviour in every worker state, only filled for parallel behaviours
+		std::vector<int> workerBehaviourIds;
+	};
+
+	// Declared before the state, which frees its memory through it when closed
+	LuaAllocator allocator;
+	// Declared before the Lua references below so they are released before the state is closed
+	sol::state lua;
+	// Declared after the state, it removes its hook before the state is closed
+	LuaProfiler profiler;
+	int profilerSampleInterval = 0;
+	// Lua heap when the last garbage collection cycle finished
+	size_t heapBytesAfterCycle = 0;
+	std::string scriptDirectory;
+	BytecodeCache bytecodeCache;
+	// Scripts found in the archive are loaded from it, everything else from loose files
+	const AssetArchive* archive = nullptr;
+	std::vector<Behaviour> behaviours;
+	// Names that failed to load map to -1, so they are only tried once
+	std::unordered_map<std::string, int> behaviourIds;
+	// States of the job workers besides the calling thread, the worker with index i uses workerEngines[i - 1]
+	std::vector<std::unique_ptr<ScriptEngine>> workerEngines;
+	// Set in every state, kept for worker states created later
+	std::unordered_map<std::string, double> globals;
+
+	void RegisterBindings();
+	void LoadIntoWorkers(Behaviour& behaviour);
+	bool CallUpdate(Behaviour& behaviour, EntityBatch& batch, double deltaTime, std::string& error);
+
+public:
+	ScriptEngine(const std::string& scriptDirectory);
+	~ScriptEngine();
+
+	ScriptEngine(const ScriptEngine&) = delete;
+	ScriptEngine& operator=(const ScriptEngine&) = delete;
+
+	// An empty directory disables the cache
+	void SetBytecodeCacheDirectory(const std::string& directory);
+	// The archive has to stay mounted while the engine loads scripts
+	void SetArchive(const AssetArchive* archive);
+
+	// Creates a state for every job worker but the calling thread, with the same bindings, globals and script
+	// sources. Has to be called before any behaviour is loaded.
+	void CreateWorkerStates(int numThreads);
+	int GetNumStates() const {
+		return static_cast<int>(workerEngines.size()) + 1;
+	}
+	// Sets a global in every state
+	void SetGlobal(const std::string& name, double value);
+
+	// Loads a script or data file as a function without running it. Prefers the archive, then cached bytecode
+	// of the same source, and compiles the source otherwise, storing the result in the cache.
+	sol::load_result LoadScript(const std::string& filePath);
+
+	// PackTransform replacing Lua scripts with their bytecode, so release builds do not compile scripts at all
+	static bool CompileForArchive(const std::string& filePath, std::vector<char>& contents);
+
+	// Loads the behaviour on first use, returns -1 if it can not be loaded
+	int GetBehaviourId(const std::string& name);
+	int GetNumBehaviours() const;
+
+	bool HasUpdate(int behaviourId) const;
+	// True if the behaviour asked for it and the worker states loaded it too
+	bool IsParallel(int behaviourId) const;
+	bool IsDisabled(int behaviourId) const;
+	// Returns nullptr if the behaviour has no run function or is disabled
+	const sol::protected_function* GetRoutine(int behaviourId) const;
+
+	// Calls the update function of the behaviour, returns false if the script failed
+	bool RunBehaviour(int behaviourId, EntityBatch& batch, double deltaTime);
+	// Calls the update function in the state of a job worker, worker index 0 is this state. Can be called from
+	// several threads at once with different worker indices and disjoint batches. Errors are returned instead
+	// of disabling the behaviour, the caller disables it once every worker is done.
+	bool RunBehaviourOnWorker(int behaviourId, int workerIndex, EntityBatch& batch, double deltaTime, std::string& error);
+	// Logs the error once and stops running the behaviour
+	void DisableBehaviour(int behaviourId, const std::string& error);
+
+	// Samples every state once per this many VM instructions, 0 stops sampling. Coroutines started before
+	// the call are not sampled.
+	void SetProfilerSampleInterval(int instructionsPerSample);
+	// Called once per tick before any script runs, the profiler only samples some ticks
+	void BeginProfilerTick();
+	void ResetProfiler();
+	// Merges the lines sampled in every state, writes up to maxHotspots of them with the most hits first
+	// and returns how many were written
+	int GetTopHotspots(LuaHotspot* hotspots, int maxHotspots) const;
+	uint64_t GetNumProfilerSamples() const;
+	// Writes the top hotspots as a table to the log
+	void LogHotspots(int maxHotspots) const;
+
+	// The automatic collector is stopped, garbage is only collected here in incremental steps until the
+	// budget is used up. Worker states share the budget with this one. Returns true if a cycle of this state finished.
+	bool CollectGarbage(double budgetMillisecs);
+
+	// Sums over every state
+	size_t GetHeapBytes() const;
+	size_t TakeAllocatedBytes();
+
+	const LuaAllocator& GetAllocator() const {
+		return allocator;
+	}
+
+	LuaAllocator& GetAllocator() {
+		return allocator;
+	}
+
+	sol::state& GetState() {
+		return lua;
+	}
+};
@@ -2,6 +2,7 @@
 #include "../ECS/ECS.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
+#include "../Profiler/Profiler.h"
 
 	class MovementSystem : public System {
 	public:
@@ -11,6 +12,7 @@
 		}
 
 		void Update(double deltaTime) {
+			PROFILE_SCOPE("MovementSystem::Update");
 
 			// Loop all entities that the system is interested in
 			for (auto entity : GetSystemEntities()) {
@@ -1,56 +1,108 @@
 #pragma once
 #include <SDL.h>
+#include <cmath>
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/SpriteComponent.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Renderer/RenderBackend.h"
+#include "../Profiler/Profiler.h"
 class RenderSystem: public System {
+private:
+	AssetStore& assetStore;
+	// Asset store revision the sprites were last resolved against
+	uint32_t resolvedAssetRevision;
+
+	// Returns false if the sprite texture handle is invalid
+	bool ResolveSprite(SpriteComponent& sprite) const {
+		const TextureInfo* textureInfo = assetStore.GetTextureInfo(sprite.texture);
+		if (!textureInfo) {
+			return false;
+		}
+
+		// The source rectangle is relative to the asset, which might be a region of an atlas
+		sprite.resolvedSrcRect = sprite.srcRect;
+		if (sprite.srcRect.w == 0 && sprite.srcRect.h == 0) {
+			sprite.resolvedSrcRect.w = textureInfo->width;
+			sprite.resolvedSrcRect.h = textureInfo->height;
+		}
+		sprite.resolvedSrcRect.x += textureInfo->atlasRect.x;
+		sprite.resolvedSrcRect.y += textureInfo->atlasRect.y;
+
+		sprite.resolvedWidth = sprite.width;
+		sprite.resolvedHeight = sprite.height;
+		if (sprite.width == 0 && sprite.height == 0) {
+			sprite.resolvedWidth = sprite.resolvedSrcRect.w;
+			sprite.resolvedHeight = sprite.resolvedSrcRect.h;
+		}
+		return true;
+	}
 
 public:
-	RenderSystem() {
+	RenderSystem(AssetStore& assetStore): assetStore(assetStore), resolvedAssetRevision(assetStore.GetRevision()) {
 		RequireComponent<TransformComponent>();
 		RequireComponent<SpriteComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore) {
+	// Resolve the sprite texture and its size once, so the render loop does no lookups or SDL queries.
+	// The sprite keeps its texture referenced, so it is not evicted while the entity lives.
+	void OnEntityAdded(Entity entity) override {
+		auto& sprite = entity.GetComponent<SpriteComponent>();
+		if (!ResolveSprite(sprite)) {
+			MIRAGE_LOG_ERROR("Sprite of entity id {} uses an invalid texture handle", entity.GetId());
+			return;
+		}
+		assetStore.AddRef(sprite.texture);
+	}
 
-		for (auto entity : GetSystemEntities()) {
-			const auto transform = entity.GetComponent<TransformComponent>();
-			const auto sprite = entity.GetComponent<SpriteComponent>();
-			SDL_Texture* texture = assetStore->GetTexture(sprite.assetId);
+	void OnEntityRemoved(Entity entity) override {
+		assetStore.Release(entity.GetComponent<SpriteComponent>().texture);
+	}
 
-			// Set the source rectangle for our original sprite texture
-			SDL_Rect srcRect = sprite.srcRect;
+	// Extracts the draw commands of this frame, the frame is rendered later on the render thread.
+	// Transforms are interpolated between the last two simulation ticks, alpha is how far
+	// the render time is past the last tick as a fraction of the tick duration. The previous
+	// state is kept by the TransformSnapshotSystem.
+	// The vector is cleared and reused, so extracting does not allocate once it has grown.
+	void Update(RenderFrame& renderFrame, double alpha) {
+		PROFILE_SCOPE("RenderSystem::Update");
 
-			if (srcRect.w == 0 && srcRect.h == 0) {
-				SDL_QueryTexture(texture, NULL, NULL, &srcRect.w, &srcRect.h);
+		// Textures finished loading or were replaced since the last frame, their sizes may have changed
+		if (assetStore.GetRevision() != resolvedAssetRevision) {
+			resolvedAssetRevision = assetStore.GetRevision();
+			for (auto entity : GetSystemEntities()) {
+				ResolveSprite(entity.GetComponent<SpriteComponent>());
 			}
-			auto spriteWidth = sprite.width;
-			auto spriteHeight = sprite.height;
+		}
 
-			if (spriteWidth == 0 && spriteHeight == 0) {
-				spriteWidth = srcRect.w;
-				spriteHeight = srcRect.h;
-			}
+		auto& sprites = renderFrame.sprites;
+		sprites.clear();
 
-			// Set the destination rectangle with the x, y position to be rendered
-			SDL_Rect dstRect = {
-				static_cast<int>(transform.position.x),
-				static_cast<int>(transform.position.y),
-				static_cast<int>(spriteWidth * transform.scale.x),
-				static_cast<int>(spriteWidth * transform.scale.y)
-			};
+		const float alphaFloat = static_cast<float>(alpha);
 
-			// Draw PNG texture based on the sprite ID
-			SDL_RenderCopyEx(
-				renderer,
-				texture,
-				&srcRect,
-				&dstRect,
-				transform.rotation,
-				NULL,
-				SDL_FLIP_NONE
-			);
-				
+		for (auto entity : GetSystemEntities()) {
+			const auto& transform = entity.GetComponent<TransformComponent>();
+			const auto& sprite = entity.GetComponent<SpriteComponent>();
+
+			const glm::vec2 position = glm::mix(transform.previousPosition, transform.position, alphaFloat);
+			const glm::vec2 scale = glm::mix(transform.previousScale, transform.scale, alphaFloat);
+
+			SpriteDrawCommand command;
+			command.texture = sprite.texture;
+			command.srcRect = sprite.resolvedSrcRect;
 
+			// Set the destination rectangle with the x, y position to be rendered
+			command.dstRect = {
+				static_cast<int>(position.x),
+				static_cast<int>(position.y),
+				static_cast<int>(sprite.resolvedWidth * scale.x),
+				static_cast<int>(sprite.resolvedHeight * scale.y)
+			};
+			// The short way around, a step from 359 to 1 degrees turns 2 degrees instead of going back 358
+			const double rotationStep = std::remainder(transform.rotation - transform.previousRotation, 360.0);
+			command.rotation = transform.previousRotation + rotationStep * alpha;
 
+			sprites.push_back(command);
 		}
 	}
 
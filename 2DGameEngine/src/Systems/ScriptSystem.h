@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include "../ECS/ECS.h"
+#include "../Components/ScriptComponent.h"
+#include "../Scripting/ScriptEngine.h"
+#include "../Scripting/CoroutineScheduler.h"
+#include "../EngineCounters/EngineCounters.h"
+#include "../Profiler/Profiler.h"
+#include "../JobSystem/JobSystem.h"
+
+// Batches of parallel behaviours are split into at most this many ranges per job thread, so a worker that
+// finishes early picks up another range
+const int SCRIPT_RANGES_PER_THREAD = 2;
+// Smaller ranges cost more in waking workers than they save
+const int SCRIPT_MIN_RANGE_ENTITIES = 512;
+
+class ScriptSystem: public System {
+private:
+	// The batch of a parallel behaviour split into disjoint ranges, each updated in whichever worker state
+	// picks it up
+	struct ParallelBatch {
+		// Sized once, views kept by scripts point at the range batches
+		std::vector<EntityBatch> ranges;
+		std::vector<std::string> errors;
+		int numRanges = 0;
+		// Version of the whole batch when it was split
+		uint32_t batchVersion = 0;
+	};
+
+	ScriptEngine& scriptEngine;
+	// Runs parallel behaviours, null runs everything on the calling thread
+	JobSystem* jobSystem;
+	// Entities grouped by behaviour id, so Lua is entered once per behaviour instead of once per entity.
+	// Deques never move their elements when growing, views kept by scripts point at the batches.
+	std::deque<EntityBatch> batches;
+	std::deque<ParallelBatch> parallelBatches;
+	// Run functions of the behaviours, one coroutine per entity
+	CoroutineScheduler scheduler;
+
+	void SplitBatch(const EntityBatch& batch, ParallelBatch& parallelBatch) {
+		if (parallelBatch.ranges.empty()) {
+			parallelBatch.ranges.resize(jobSystem->GetNumThreads() * SCRIPT_RANGES_PER_THREAD);
+			parallelBatch.errors.resize(parallelBatch.ranges.size());
+		}
+
+		const int count = batch.GetCount();
+		parallelBatch.numRanges = std::clamp(count / SCRIPT_MIN_RANGE_ENTITIES, 1, static_cast<int>(parallelBatch.ranges.size()));
+		for (int rangeIndex = 0; rangeIndex < static_cast<int>(parallelBatch.ranges.size()); rangeIndex++) {
+			// Unused ranges are emptied too, so views kept on them turn stale
+			const int first = std::min(count, count * rangeIndex / parallelBatch.numRanges);
+			const int last = std::min(count, count * (rangeIndex + 1) / parallelBatch.numRanges);
+			parallelBatch.ranges[rangeIndex].Assign(batch.entities.begin() + first, batch.entities.begin() + last);
+		}
+		parallelBatch.batchVersion = batch.version;
+	}
+
+	// Returns the number of calls into Lua
+	int RunParallel(int behaviourId, double deltaTime) {
+		ParallelBatch& parallelBatch = parallelBatches[behaviourId];
+		if (parallelBatch.batchVersion != batches[behaviourId].version) {
+			SplitBatch(batches[behaviourId], parallelBatch);
+		}
+
+		// Every range has its own entities and command queue, and every worker its own Lua state
+		jobSystem->ParallelFor(parallelBatch.numRanges, [&](int rangeIndex, int workerIndex) {
+			scriptEngine.RunBehaviourOnWorker(behaviourId, workerIndex, parallelBatch.ranges[rangeIndex], deltaTime, parallelBatch.errors[rangeIndex]);
+		});
+
+		for (std::string& error : parallelBatch.errors) {
+			if (!error.empty()) {
+				scriptEngine.DisableBehaviour(behaviourId, error);
+				error.clear();
+			}
+		}
+		return parallelBatch.numRanges;
+	}
+
+	void ApplyCommands(EntityBatch& batch) {
+		for (const ScriptCommand& command : batch.commands) {
+			switch (command.type) {
+			case SCRIPT_COMMAND_KILL: {
+				// Killed entities stay alive until the registry updates, a second kill is harmless
+				Entity entity = command.entity;
+				entity.Kill();
+				break;
+			}
+			}
+		}
+		batch.commands.clear();
+	}
+
+public:
+	// The script engine needs a worker state per thread of the job system to run behaviours in parallel
+	ScriptSystem(ScriptEngine& scriptEngine, JobSystem* jobSystem = nullptr): scriptEngine(scriptEngine), jobSystem(jobSystem), scheduler(scriptEngine.GetState().lua_state()) {
+		RequireComponent<ScriptComponent>();
+
+		if (jobSystem && jobSystem->GetNumThreads() > scriptEngine.GetNumStates()) {
+			MIRAGE_LOG_ERROR("The script engine has fewer states than the job system has threads, behaviours run serially");
+			this->jobSystem = nullptr;
+		}
+	}
+
+	void OnEntityAdded(Entity entity) override {
+		auto& script = entity.GetComponent<ScriptComponent>();
+		script.behaviourId = scriptEngine.GetBehaviourId(script.behaviour);
+		if (script.behaviourId < 0) {
+			MIRAGE_LOG_ERROR("Entity id {} uses the unknown behaviour {}", entity.GetId(), script.behaviour);
+			return;
+		}
+
+		if (scriptEngine.HasUpdate(script.behaviourId)) {
+			if (script.behaviourId >= static_cast<int>(batches.size())) {
+				batches.resize(script.behaviourId + 1);
+				parallelBatches.resize(script.behaviourId + 1);
+			}
+			batches[script.behaviourId].Add(entity);
+		}
+
+		const sol::protected_function* routine = scriptEngine.GetRoutine(script.behaviourId);
+		if (routine) {
+			script.coroutineId = scheduler.Start(*routine, script.behaviourId, entity);
+		}
+	}
+
+	void OnEntityRemoved(Entity entity) override {
+		const auto& script = entity.GetComponent<ScriptComponent>();
+		if (script.behaviourId < 0) {
+			return;
+		}
+		if (scriptEngine.HasUpdate(script.behaviourId)) {
+			batches[script.behaviourId].Remove(entity);
+		}
+		scheduler.Stop(script.coroutineId, entity);
+	}
+
+	void Update(double deltaTime) {
+		PROFILE_SCOPE("ScriptSystem::Update");
+		scriptEngine.BeginProfilerTick();
+
+		int calls = 0;
+		for (int behaviourId = 0; behaviourId < static_cast<int>(batches.size()); behaviourId++) {
+			EntityBatch& batch = batches[behaviourId];
+			if (batch.entities.empty()) {
+				continue;
+			}
+			if (jobSystem && scriptEngine.IsParallel(behaviourId) && !scriptEngine.IsDisabled(behaviourId)) {
+				calls += RunParallel(behaviourId, deltaTime);
+			}
+			else {
+				scriptEngine.RunBehaviour(behaviourId, batch, deltaTime);
+				calls++;
+			}
+		}
+		EngineCounters::Add(COUNTER_SCRIPT_CALLS, calls);
+
+		// Structural changes are applied once no behaviour runs anymore
+		for (int behaviourId = 0; behaviourId < static_cast<int>(batches.size()); behaviourId++) {
+			ApplyCommands(batches[behaviourId]);
+			for (EntityBatch& range : parallelBatches[behaviourId].ranges) {
+				ApplyCommands(range);
+			}
+		}
+
+		// Only the coroutines whose wait ends this tick are resumed, sleeping ones cost nothing
+		int resumed = scheduler.Update(deltaTime);
+		for (const CoroutineFailure& failure : scheduler.GetFailures()) {
+			scriptEngine.DisableBehaviour(failure.behaviourId, "entity id " + std::to_string(failure.entityId) + ": " + failure.message);
+			scheduler.StopBehaviour(failure.behaviourId);
+		}
+		EngineCounters::Add(COUNTER_COROUTINES_RESUMED, resumed);
+		EngineCounters::Set(COUNTER_COROUTINES_RUNNING, scheduler.GetNumRunning());
+	}
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Profiler/Profiler.h"
+
+// Keeps the previous state of every transform, whichever system reads it
+class TransformSnapshotSystem: public System {
+public:
+	TransformSnapshotSystem() {
+		RequireComponent<TransformComponent>();
+	}
+
+	// Stores the current transforms as the previous ones, called before every simulation tick
+	void Update() {
+		PROFILE_SCOPE("TransformSnapshotSystem::Update");
+
+		for (auto entity : GetSystemEntities()) {
+			auto& transform = entity.GetComponent<TransformComponent>();
+			transform.previousPosition = transform.position;
+			transform.previousScale = transform.scale;
+			transform.previousRotation = transform.rotation;
+		}
+	}
+};
@@ -0,0 +1,107 @@
+#include "TextureCache.h"
+#include "../AssetArchive/AssetArchive.h"
+#include "../Logger/Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <cstdio>
+
+const uint64_t TEXTURE_CACHE_ALIGNMENT = 64;
+
+void TextureCache::SetDirectory(const std::string& directory) {
+	this->directory = directory;
+}
+
+bool TextureCache::IsEnabled() const {
+	return !directory.empty();
+}
+
+std::string TextureCache::GetCacheFilePath(const std::string& sourcePath) const {
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.rgba", static_cast<unsigned long long>(AssetArchive::HashPath(sourcePath)));
+	return directory + "/" + fileName;
+}
+
+SDL_Surface* TextureCache::Load(const std::string& sourcePath, const uint8_t* sourceData, size_t sourceSize, int64_t sourceModifiedTime, std::shared_ptr<MappedFile>& mapping) const {
+	if (!IsEnabled()) {
+		return nullptr;
+	}
+
+	const std::string cacheFilePath = GetCacheFilePath(sourcePath);
+	if (!std::filesystem::exists(cacheFilePath)) {
+		return nullptr;
+	}
+
+	std::shared_ptr<MappedFile> cacheFile = std::make_shared<MappedFile>();
+	if (!cacheFile->Open(cacheFilePath) || cacheFile->GetSize() < sizeof(TextureCacheHeader)) {
+		return nullptr;
+	}
+
+	// Cheap checks first, the content hash catches changes that kept the size and time
+	const TextureCacheHeader* header = reinterpret_cast<const TextureCacheHeader*>(cacheFile->GetData());
+	if (header->magic != TEXTURE_CACHE_MAGIC || header->version != TEXTURE_CACHE_VERSION ||
+		header->sourceSize != sourceSize || header->sourceModifiedTime != sourceModifiedTime ||
+		header->pixelOffset > cacheFile->GetSize() ||
+		static_cast<uint64_t>(header->pitch) * header->height > cacheFile->GetSize() - header->pixelOffset ||
+		header->sourceHash != AssetArchive::HashBytes(sourceData, sourceSize)) {
+		return nullptr;
+	}
+
+	// SDL only reads from the pixels, the mapping stays read only
+	void* pixels = const_cast<uint8_t*>(cacheFile->GetData() + header->pixelOffset);
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, header->width, header->height, 32, header->pitch, SDL_PIXELFORMAT_RGBA32);
+	if (surface) {
+		mapping = cacheFile;
+	}
+	return surface;
+}
+
+void TextureCache::Store(const std::string& sourcePath, const uint8_t* sourceData, size_t sourceSize, int64_t sourceModifiedTime, SDL_Surface* surface) const {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	TextureCacheHeader header = {};
+	header.magic = TEXTURE_CACHE_MAGIC;
+	header.version = TEXTURE_CACHE_VERSION;
+	header.sourceSize = sourceSize;
+	header.sourceModifiedTime = sourceModifiedTime;
+	header.sourceHash = AssetArchive::HashBytes(sourceData, sourceSize);
+	header.width = surface->w;
+	header.height = surface->h;
+	header.pitch = surface->w * 4;
+	header.pixelOffset = (sizeof(header) + TEXTURE_CACHE_ALIGNMENT - 1) / TEXTURE_CACHE_ALIGNMENT * TEXTURE_CACHE_ALIGNMENT;
+
+	// Written under a temporary name and renamed, so a reader never maps a half written file
+	const std::string cacheFilePath = GetCacheFilePath(sourcePath);
+	const std::string temporaryPath = cacheFilePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		const char zeros[TEXTURE_CACHE_ALIGNMENT] = {};
+		file.write(zeros, static_cast<std::streamsize>(header.pixelOffset - sizeof(header)));
+
+		SDL_LockSurface(surface);
+		for (int y = 0; y < surface->h; y++) {
+			file.write(static_cast<const char*>(surface->pixels) + static_cast<size_t>(y) * surface->pitch, header.pitch);
+		}
+		SDL_UnlockSurface(surface);
+
+		if (!file) {
+			MIRAGE_LOG_ERROR("Error writing texture cache file {}", temporaryPath);
+			file.close();
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryPath, cacheFilePath, error);
+	if (error) {
+		// The old entry is still mapped somewhere, it stays invalid and is written again next time
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
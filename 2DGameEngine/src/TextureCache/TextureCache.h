@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <SDL.h>
+#include "../AssetArchive/MappedFile.h"
+
+const uint32_t TEXTURE_CACHE_MAGIC = 0x5845544D; // "MTEX"
+const uint32_t TEXTURE_CACHE_VERSION = 1;
+
+// Header of a cache file, the RGBA32 pixels follow at pixelOffset
+struct TextureCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	// The source file the pixels were decoded from, any difference invalidates the entry
+	uint64_t sourceSize;
+	int64_t sourceModifiedTime;
+	uint64_t sourceHash;
+	uint32_t width;
+	uint32_t height;
+	uint32_t pitch;
+	uint32_t reserved;
+	uint64_t pixelOffset;
+};
+
+// On disk cache of decoded textures, one raw RGBA32 file per source path that is memory mapped on load.
+// Thread safe, every call only touches the cache file of its own source path.
+class TextureCache
+{
+private:
+	std::string directory;
+
+	std::string GetCacheFilePath(const std::string& sourcePath) const;
+
+public:
+	// An empty directory disables the cache
+	void SetDirectory(const std::string& directory);
+	bool IsEnabled() const;
+
+	// Returns an RGBA32 surface whose pixels point into the mapped cache file, the mapping has to be
+	// kept alive as long as the surface is used. Returns nullptr if there is no valid entry.
+	SDL_Surface* Load(const std::string& sourcePath, const uint8_t* sourceData, size_t sourceSize, int64_t sourceModifiedTime, std::shared_ptr<MappedFile>& mapping) const;
+
+	// Writes the RGBA32 surface as the entry of the source
+	void Store(const std::string& sourcePath, const uint8_t* sourceData, size_t sourceSize, int64_t sourceModifiedTime, SDL_Surface* surface) const;
+};